@@ -0,0 +1,508 @@
+#ifndef MTL_PY_LUT_QOR_H_
+#define MTL_PY_LUT_QOR_H_
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <vector>
+#include "global/global.h"
+#include "algo/StructuralHash.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// Maximum LUT size supported by the estimator
+constexpr IndexType LUT_QOR_MAX_K = 8;
+
+/// @class MTL_PY::MapQor
+/// @brief QoR of a k-LUT mapping
+class MapQor
+{
+    public:
+        explicit MapQor() = default;
+        IndexType lutCount() const { return _lutCount; }
+        IndexType lutDepth() const { return _lutDepth; }
+        /// @brief number of nodes whose cuts came from the cache
+        IndexType numReused() const { return _numReused; }
+        /// @brief number of nodes whose cuts were enumerated
+        IndexType numComputed() const { return _numComputed; }
+        RealType time() const { return _time; }
+
+        void setLutCount(IndexType lutCount) { _lutCount = lutCount; }
+        void setLutDepth(IndexType lutDepth) { _lutDepth = lutDepth; }
+        void setNumReused(IndexType numReused) { _numReused = numReused; }
+        void setNumComputed(IndexType numComputed) { _numComputed = numComputed; }
+        void setTime(RealType time) { _time = time; }
+    private:
+        IndexType _lutCount = 0;    ///< Number of LUTs
+        IndexType _lutDepth = 0;    ///< Number of LUT levels
+        IndexType _numReused = 0;   ///< Nodes served by the cut cache
+        IndexType _numComputed = 0; ///< Nodes enumerated in this call
+        RealType  _time = 0;        ///< Wall-clock seconds
+};
+
+/// @class MTL_PY::LutQorEstimator
+/// @brief Incremental k-LUT mapper used as a QoR reward
+/// Priority cuts are cached under the structural key of their root, with the
+/// leaves also stored as structural keys. A node whose transitive fanin did
+/// not change since the previous call keeps its key and reuses its cuts, so
+/// only the regions rewritten by the last operation are enumerated again.
+/// The mapping itself is a delay-optimal pass followed by one area-flow
+/// recovery pass under the optimal depth, as in the priority-cut mappers.
+class LutQorEstimator
+{
+    public:
+        explicit LutQorEstimator() = default;
+        /// @brief set the number of priority cuts kept per node
+        void setCutLimit(IndexType cutLimit) { _cutLimit = std::max<IndexType>(cutLimit, 1); }
+        /// @brief drop the cached cuts and release the scratch
+        void clear();
+        /// @brief estimate the memory held by the cache and the scratch, in bytes
+        std::uint64_t memoryBytes() const;
+        /// @brief map the network into k-LUTs
+        /// @return the LUT count and depth
+        template<class Ntk>
+        MapQor run(Ntk const &ntk, IndexType k);
+
+    private:
+        /// A cut over node indices of the current call, leaves sorted
+        struct Cut
+        {
+            std::array<IndexType, LUT_QOR_MAX_K> leaves;
+            IndexType size = 0;
+        };
+        /// A cached cut over structural keys
+        struct KeyCut
+        {
+            std::array<std::uint64_t, LUT_QOR_MAX_K> leaves;
+            IndexType size = 0;
+        };
+
+        static bool mergeCuts(const Cut &a, const Cut &b, IndexType k, Cut &out);
+        static bool dominates(const Cut &a, const Cut &b);
+        IndexType cutArrival(const Cut &cut) const;
+        void filterCuts(std::vector<Cut> &cuts) const;
+        /// A slot of an open-addressing table keyed by structural key
+        struct KeySlot
+        {
+            std::uint64_t key = 0;
+            IndexType     value = INDEX_TYPE_MAX; ///< INDEX_TYPE_MAX if the slot is empty
+            IndexType     count = 0;
+        };
+        static void resetTable(std::vector<KeySlot> &table, std::size_t numKeys);
+        static KeySlot & slotOf(std::vector<KeySlot> &table, std::uint64_t key);
+        static const KeySlot * findSlot(const std::vector<KeySlot> &table, std::uint64_t key);
+        void buildKeyTable(const std::vector<std::uint64_t> &keys);
+        IndexType findKey(std::uint64_t key) const;
+
+    private:
+        IndexType                                              _cutLimit = 8;  ///< Priority cuts per node
+        IndexType                                              _cacheK = 0;    ///< LUT size of the cached cuts
+        std::vector<KeySlot>                                   _cacheTable;    ///< Structural key to a range of _cachePool
+        std::vector<KeyCut>                                    _cachePool;     ///< The cached cuts, contiguous per node
+        // Scratch of the current call
+        std::vector<std::vector<Cut>>                          _cuts;          ///< Priority cuts, trivial cut excluded
+        std::vector<IndexType>                                 _arrival;       ///< Delay-optimal arrival
+        std::vector<RealType>                                  _areaFlow;      ///< Area flow of the best cut
+        std::vector<IndexType>                                 _required;      ///< Required time in the cover
+        std::vector<Byte>                                      _isLeafOnly;    ///< Constant or PI
+        std::vector<Byte>                                      _isConst;       ///< Constant node
+        std::vector<KeySlot>                                   _keyTable;      ///< Structural key to node index
+};
+
+inline void LutQorEstimator::clear()
+{
+    decltype(_cacheTable)().swap(_cacheTable);
+    decltype(_cachePool)().swap(_cachePool);
+    _cacheK = 0;
+    decltype(_cuts)().swap(_cuts);
+    decltype(_arrival)().swap(_arrival);
+    decltype(_areaFlow)().swap(_areaFlow);
+    decltype(_required)().swap(_required);
+    decltype(_isLeafOnly)().swap(_isLeafOnly);
+    decltype(_isConst)().swap(_isConst);
+    decltype(_keyTable)().swap(_keyTable);
+}
+
+/// Size a table for numKeys keys at most half full, all slots empty
+inline void LutQorEstimator::resetTable(std::vector<KeySlot> &table, std::size_t numKeys)
+{
+    std::size_t capacity = 16;
+    while (capacity < 2 * numKeys) { capacity <<= 1; }
+    table.assign(capacity, KeySlot());
+}
+
+/// The slot of a key, or the empty slot where it goes. The keys are already
+/// mixed, so their low bits index the power-of-two table, with linear probing
+inline LutQorEstimator::KeySlot & LutQorEstimator::slotOf(std::vector<KeySlot> &table, std::uint64_t key)
+{
+    const std::size_t mask = table.size() - 1;
+    std::size_t slot = key & mask;
+    while (table[slot].value != INDEX_TYPE_MAX && table[slot].key != key)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return table[slot];
+}
+
+/// The slot of a key, nullptr if absent
+inline const LutQorEstimator::KeySlot * LutQorEstimator::findSlot(const std::vector<KeySlot> &table, std::uint64_t key)
+{
+    if (table.empty())
+    {
+        return nullptr;
+    }
+    const std::size_t mask = table.size() - 1;
+    for (std::size_t slot = key & mask; ; slot = (slot + 1) & mask)
+    {
+        if (table[slot].value == INDEX_TYPE_MAX)
+        {
+            return nullptr;
+        }
+        if (table[slot].key == key)
+        {
+            return &table[slot];
+        }
+    }
+}
+
+/// Map every key to the first node that has it
+inline void LutQorEstimator::buildKeyTable(const std::vector<std::uint64_t> &keys)
+{
+    resetTable(_keyTable, keys.size());
+    for (IndexType i = 0; i < keys.size(); ++i)
+    {
+        KeySlot &slot = slotOf(_keyTable, keys[i]);
+        if (slot.value == INDEX_TYPE_MAX)
+        {
+            slot.key = keys[i];
+            slot.value = i;
+        }
+    }
+}
+
+/// The node of a key, INDEX_TYPE_MAX if no node has it
+inline IndexType LutQorEstimator::findKey(std::uint64_t key) const
+{
+    const KeySlot *slot = findSlot(_keyTable, key);
+    return slot != nullptr ? slot->value : INDEX_TYPE_MAX;
+}
+
+inline std::uint64_t LutQorEstimator::memoryBytes() const
+{
+    std::uint64_t bytes = _cacheTable.capacity() * sizeof(KeySlot) + _cachePool.capacity() * sizeof(KeyCut);
+    bytes += _keyTable.capacity() * sizeof(KeySlot);
+    // Every cut vector is a separate heap block: glibc adds an 8-byte header and rounds to 16 bytes, 32 at least
+    auto heapBlock = [](std::uint64_t bytes) { return bytes == 0 ? 0 : std::max<std::uint64_t>(32, (bytes + 8 + 15) & ~std::uint64_t(15)); };
+    bytes += _cuts.capacity() * sizeof(std::vector<Cut>);
+    for (const auto &cuts : _cuts)
+    {
+        bytes += heapBlock(cuts.capacity() * sizeof(Cut));
+    }
+    bytes += _arrival.capacity() * sizeof(IndexType) + _areaFlow.capacity() * sizeof(RealType);
+    bytes += _required.capacity() * sizeof(IndexType) + _isLeafOnly.capacity() + _isConst.capacity();
+    return bytes;
+}
+
+/// Union of two sorted leaf sets, fails above k leaves
+inline bool LutQorEstimator::mergeCuts(const Cut &a, const Cut &b, IndexType k, Cut &out)
+{
+    IndexType i = 0, j = 0;
+    out.size = 0;
+    while (i < a.size || j < b.size)
+    {
+        IndexType next;
+        if (j >= b.size || (i < a.size && a.leaves[i] < b.leaves[j])) { next = a.leaves[i++]; }
+        else if (i >= a.size || b.leaves[j] < a.leaves[i]) { next = b.leaves[j++]; }
+        else { next = a.leaves[i++]; ++j; }
+        if (out.size == k)
+        {
+            return false;
+        }
+        out.leaves[out.size++] = next;
+    }
+    return true;
+}
+
+/// Whether the leaves of a are a subset of the leaves of b
+inline bool LutQorEstimator::dominates(const Cut &a, const Cut &b)
+{
+    if (a.size > b.size)
+    {
+        return false;
+    }
+    IndexType j = 0;
+    for (IndexType i = 0; i < a.size; ++i)
+    {
+        while (j < b.size && b.leaves[j] < a.leaves[i]) { ++j; }
+        if (j == b.size || b.leaves[j] != a.leaves[i])
+        {
+            return false;
+        }
+        ++j;
+    }
+    return true;
+}
+
+inline IndexType LutQorEstimator::cutArrival(const Cut &cut) const
+{
+    IndexType arrival = 0;
+    for (IndexType i = 0; i < cut.size; ++i)
+    {
+        arrival = std::max(arrival, _arrival[cut.leaves[i]]);
+    }
+    return arrival + 1;
+}
+
+/// Sort by (arrival, size), drop duplicates and dominated cuts, keep the best _cutLimit
+inline void LutQorEstimator::filterCuts(std::vector<Cut> &cuts) const
+{
+    std::vector<std::pair<IndexType, IndexType>> order; // (arrival, position)
+    order.reserve(cuts.size());
+    for (IndexType c = 0; c < cuts.size(); ++c)
+    {
+        order.emplace_back(cutArrival(cuts[c]), c);
+    }
+    std::sort(order.begin(), order.end(), [&](const auto &a, const auto &b) {
+        if (a.first != b.first) { return a.first < b.first; }
+        return cuts[a.second].size < cuts[b.second].size;
+    });
+    std::vector<Cut> kept;
+    kept.reserve(_cutLimit);
+    for (const auto &o : order)
+    {
+        const Cut &cut = cuts[o.second];
+        bool dominated = false;
+        for (const Cut &k : kept)
+        {
+            // A kept cut has no later arrival, a subset of it makes this one useless
+            if (dominates(k, cut)) { dominated = true; break; }
+        }
+        if (!dominated)
+        {
+            kept.emplace_back(cut);
+            if (kept.size() == _cutLimit) { break; }
+        }
+    }
+    cuts.swap(kept);
+}
+
+template<class Ntk>
+MapQor LutQorEstimator::run(Ntk const &ntk, IndexType k)
+{
+    MTL_TRACE_SPAN(DETAIL, "LutQorEstimator::run");
+    auto beginTime = std::chrono::steady_clock::now();
+    k = std::min(std::max<IndexType>(k, 2), LUT_QOR_MAX_K);
+    if (k != _cacheK)
+    {
+        _cacheTable.clear();
+        _cachePool.clear();
+        _cacheK = k;
+    }
+    const IndexType size = ntk.size();
+    std::vector<std::uint64_t> keys;
+    structuralKeys(ntk, keys);
+    buildKeyTable(keys);
+
+    // The cut vectors keep their capacity across calls
+    _cuts.resize(size);
+    for (auto &cuts : _cuts) { cuts.clear(); }
+    _arrival.assign(size, 0);
+    _areaFlow.assign(size, 0);
+    _required.assign(size, INDEX_TYPE_MAX);
+    _isLeafOnly.assign(size, 0);
+    _isConst.assign(size, 0);
+    std::vector<KeySlot> nextTable;
+    resetTable(nextTable, size);
+    std::vector<KeyCut> nextPool;
+    nextPool.reserve(std::max<std::size_t>(_cachePool.size(), size));
+    IndexType numReused = 0, numComputed = 0;
+
+    // Forward: cuts, delay-optimal arrival and area flow
+    std::vector<Cut> merged, tmp;
+    ntk.foreach_node([&](auto const &n) {
+        const IndexType idx = ntk.node_to_index(n);
+        if (ntk.is_constant(n) || ntk.is_pi(n))
+        {
+            _isLeafOnly[idx] = 1;
+            _isConst[idx] = ntk.is_constant(n) ? 1 : 0;
+            return;
+        }
+        // A node sharing its key with an earlier node of this call finds its cuts already in nextPool
+        KeySlot &next = slotOf(nextTable, keys[idx]);
+        const KeyCut *cached = nullptr;
+        IndexType numCached = 0;
+        bool fromPrevious = false;
+        if (next.value != INDEX_TYPE_MAX)
+        {
+            cached = nextPool.data() + next.value;
+            numCached = next.count;
+        }
+        else if (const KeySlot *hit = findSlot(_cacheTable, keys[idx]))
+        {
+            cached = _cachePool.data() + hit->value;
+            numCached = hit->count;
+            fromPrevious = true;
+        }
+        bool reused = false;
+        if (cached != nullptr)
+        {
+            reused = true;
+            for (IndexType c = 0; c < numCached && reused; ++c)
+            {
+                const KeyCut &kc = cached[c];
+                Cut cut;
+                cut.size = kc.size;
+                for (IndexType l = 0; l < kc.size && reused; ++l)
+                {
+                    const IndexType leaf = findKey(kc.leaves[l]);
+                    if (leaf >= idx) { reused = false; }
+                    else { cut.leaves[l] = leaf; }
+                }
+                std::sort(cut.leaves.begin(), cut.leaves.begin() + cut.size);
+                _cuts[idx].emplace_back(cut);
+            }
+            if (!reused)
+            {
+                _cuts[idx].clear();
+            }
+            else if (fromPrevious)
+            {
+                // Already encoded over keys: copied over as is
+                next.key = keys[idx];
+                next.value = static_cast<IndexType>(nextPool.size());
+                next.count = numCached;
+                nextPool.insert(nextPool.end(), cached, cached + numCached);
+            }
+        }
+        if (reused)
+        {
+            ++numReused;
+        }
+        else
+        {
+            ++numComputed;
+            // Cross product of the fanin cut sets, each with its trivial cut
+            merged.assign(1, Cut());
+            ntk.foreach_fanin(n, [&](auto const &f) {
+                const IndexType fi = ntk.node_to_index(ntk.get_node(f));
+                if (_isConst[fi])
+                {
+                    return; // A constant input does not take a LUT pin
+                }
+                Cut trivial;
+                trivial.size = 1;
+                trivial.leaves[0] = fi;
+                tmp.clear();
+                Cut out;
+                for (const Cut &a : merged)
+                {
+                    for (const Cut &b : _cuts[fi])
+                    {
+                        if (mergeCuts(a, b, k, out)) { tmp.emplace_back(out); }
+                    }
+                    if (mergeCuts(a, trivial, k, out)) { tmp.emplace_back(out); }
+                }
+                merged.swap(tmp);
+            });
+            filterCuts(merged);
+            _cuts[idx] = merged;
+        }
+
+        IndexType bestArrival = INDEX_TYPE_MAX;
+        RealType bestFlow = std::numeric_limits<RealType>::max();
+        const RealType fanouts = std::max<RealType>(ntk.fanout_size(n), 1);
+        for (const Cut &cut : _cuts[idx])
+        {
+            bestArrival = std::min(bestArrival, cutArrival(cut));
+            RealType flow = 1.0;
+            for (IndexType l = 0; l < cut.size; ++l) { flow += _areaFlow[cut.leaves[l]]; }
+            bestFlow = std::min(bestFlow, flow / fanouts);
+        }
+        if (_cuts[idx].empty())
+        {
+            // Every fanin is constant
+            bestArrival = 0;
+            bestFlow = 0;
+        }
+        _arrival[idx] = bestArrival;
+        _areaFlow[idx] = bestFlow;
+
+        if (reused)
+        {
+            return;
+        }
+        next.key = keys[idx];
+        next.value = static_cast<IndexType>(nextPool.size());
+        next.count = static_cast<IndexType>(_cuts[idx].size());
+        for (const Cut &cut : _cuts[idx])
+        {
+            KeyCut encoded;
+            encoded.size = cut.size;
+            for (IndexType l = 0; l < cut.size; ++l)
+            {
+                encoded.leaves[l] = keys[cut.leaves[l]];
+            }
+            nextPool.emplace_back(encoded);
+        }
+    });
+    // Only the cuts of the current design are kept for the next call
+    _cacheTable.swap(nextTable);
+    _cachePool.swap(nextPool);
+
+    // Backward: area-flow recovery under the optimal depth, deriving the cover
+    IndexType depth = 0;
+    ntk.foreach_po([&](auto const &f) {
+        depth = std::max(depth, _arrival[ntk.node_to_index(ntk.get_node(f))]);
+    });
+    ntk.foreach_po([&](auto const &f) {
+        _required[ntk.node_to_index(ntk.get_node(f))] = depth;
+    });
+    IndexType numLuts = 0;
+    for (IndexType i = size; i-- > 0;)
+    {
+        if (_isLeafOnly[i] || _required[i] == INDEX_TYPE_MAX || _cuts[i].empty())
+        {
+            continue;
+        }
+        ++numLuts;
+        const Cut *best = nullptr;
+        RealType bestFlow = std::numeric_limits<RealType>::max();
+        for (const Cut &cut : _cuts[i])
+        {
+            if (cutArrival(cut) > _required[i])
+            {
+                continue;
+            }
+            RealType flow = 1.0;
+            for (IndexType l = 0; l < cut.size; ++l) { flow += _areaFlow[cut.leaves[l]]; }
+            if (flow < bestFlow)
+            {
+                bestFlow = flow;
+                best = &cut;
+            }
+        }
+        AssertMsg(best != nullptr, "No cut meets the required time of node %u\n", i);
+        if (best == nullptr)
+        {
+            best = &_cuts[i].front();
+        }
+        for (IndexType l = 0; l < best->size; ++l)
+        {
+            IndexType &req = _required[best->leaves[l]];
+            req = std::min(req, _required[i] - 1);
+        }
+    }
+
+    MapQor qor;
+    qor.setLutCount(numLuts);
+    qor.setLutDepth(depth);
+    qor.setNumReused(numReused);
+    qor.setNumComputed(numComputed);
+    qor.setTime(std::chrono::duration<RealType>(std::chrono::steady_clock::now() - beginTime).count());
+    return qor;
+}
+
+PROJECT_NAMESPACE_END
+
+#endif // MTL_PY_LUT_QOR_H_
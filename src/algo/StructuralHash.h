@@ -0,0 +1,91 @@
+#ifndef MTL_PY_STRUCTURAL_HASH_H_
+#define MTL_PY_STRUCTURAL_HASH_H_
+
+#include <algorithm>
+#include <vector>
+#include "global/global.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// ================================================================================
+/// Structural hashing of a mockturtle network
+/// The key of a node only depends on the structure of its transitive fanin
+/// (fanin order does not matter), so it is stable across the node renumbering
+/// done by cleanup_dangling and the rebuilding algorithms.
+/// ================================================================================
+
+/// Finalizer of splitmix64
+inline std::uint64_t mixKey(std::uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+/// Key of a fanin edge: the key of the fanin node and its complement
+inline std::uint64_t edgeKey(std::uint64_t nodeKey, bool complemented)
+{
+    return mixKey(nodeKey ^ (complemented ? 0x5bd1e9955bd1e995ull : 0ull));
+}
+
+/// @brief compute the structural key of every node
+/// @param the network
+/// @param the keys, indexed by node index
+template<class Ntk>
+void structuralKeys(Ntk const &ntk, std::vector<std::uint64_t> &keys)
+{
+    keys.assign(ntk.size(), 0);
+    std::vector<std::uint64_t> fanins;
+    ntk.foreach_node([&](auto const &n) {
+        const auto idx = ntk.node_to_index(n);
+        if (ntk.is_constant(n))
+        {
+            keys[idx] = mixKey(0xc0ffeeull + static_cast<std::uint64_t>(ntk.constant_value(n)));
+            return;
+        }
+        if (ntk.is_pi(n))
+        {
+            // PIs are numbered in creation order, which every algorithm preserves
+            keys[idx] = mixKey(0x1000000000ull + ntk.pi_index(n));
+            return;
+        }
+        fanins.clear();
+        ntk.foreach_fanin(n, [&](auto const &f) {
+            fanins.emplace_back(edgeKey(keys[ntk.node_to_index(ntk.get_node(f))], ntk.is_complemented(f)));
+        });
+        std::sort(fanins.begin(), fanins.end());
+        std::uint64_t key = mixKey(fanins.size());
+        for (std::uint64_t f : fanins)
+        {
+            key = mixKey(key ^ f);
+        }
+        keys[idx] = key;
+    });
+}
+
+/// @brief the structural hash of the whole network, over its outputs in order
+/// @param the network
+/// @param the keys from structuralKeys
+template<class Ntk>
+std::uint64_t structuralHash(Ntk const &ntk, std::vector<std::uint64_t> const &keys)
+{
+    std::uint64_t hash = mixKey(ntk.num_pis());
+    ntk.foreach_po([&](auto const &f) {
+        hash = mixKey(hash ^ edgeKey(keys[ntk.node_to_index(ntk.get_node(f))], ntk.is_complemented(f)));
+    });
+    return hash;
+}
+
+/// @brief the structural hash of the whole network
+template<class Ntk>
+std::uint64_t structuralHash(Ntk const &ntk)
+{
+    std::vector<std::uint64_t> keys;
+    structuralKeys(ntk, keys);
+    return structuralHash(ntk, keys);
+}
+
+PROJECT_NAMESPACE_END
+
+#endif // MTL_PY_STRUCTURAL_HASH_H_
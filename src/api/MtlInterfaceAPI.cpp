@@ -1,17 +1,29 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
 
 #ifndef MTL_PY_MTL_INTERFACE_H_
 #define MTL_PY_MTL_INTERFACE_H_
 
 #include "global/global.h"
+#include "algo/LutQor.h"
+#include "algo/StructuralHash.h"
+#include "io/AigerParser.h"
+#include "search/RecipeSearch.h"
+#include "util/MmapFile.h"
+#include "util/SharedMemory.h"
 #include <mockturtle/mockturtle.hpp>
 #include <lorina/aiger.hpp>
 // For balancing operations
 #include <mockturtle/algorithms/balancing.hpp>
+#include <mockturtle/algorithms/functional_reduction.hpp>
 #include <mockturtle/algorithms/balancing/sop_balancing.hpp>
+// For LUT mapping
+#include <mockturtle/algorithms/lut_mapping.hpp>
+#include <mockturtle/views/mapping_view.hpp>
 
 #include <bits/stdc++.h>
+#include <omp.h>
 
 PROJECT_NAMESPACE_BEGIN
 
@@ -40,6 +52,69 @@ class MigStats
         IndexType  _lev = 0; ///< The deepest logic level
 };
 
+/// @class MTL_PY::LoadStats
+/// @brief stats of the last memory-mapped read
+class LoadStats
+{
+    public:
+        explicit LoadStats() = default;
+        std::uint64_t numBytes() const { return _numBytes; }
+        RealType parseTime() const { return _parseTime; }
+        RealType buildTime() const { return _buildTime; }
+        RealType totalTime() const { return _totalTime; }
+        /// @brief the achieved throughput over the whole read
+        RealType mbPerSec() const { return _totalTime > 0 ? _numBytes / (1024.0 * 1024.0) / _totalTime : 0.0; }
+
+        void setNumBytes(std::uint64_t numBytes) { _numBytes = numBytes; }
+        void setParseTime(RealType parseTime) { _parseTime = parseTime; }
+        void setBuildTime(RealType buildTime) { _buildTime = buildTime; }
+        void setTotalTime(RealType totalTime) { _totalTime = totalTime; }
+    private:
+        std::uint64_t _numBytes = 0; ///< Size of the input file
+        RealType   _parseTime = 0; ///< Wall-clock seconds spent decoding
+        RealType   _buildTime = 0; ///< Wall-clock seconds spent constructing the network
+        RealType   _totalTime = 0; ///< Wall-clock seconds of the whole read, mapping included
+};
+
+/// @class MTL_PY::FraigStats
+/// @brief stats of a fraig run
+class FraigStats
+{
+    public:
+        explicit FraigStats() = default;
+        /// @brief number of nodes merged into another node or a constant
+        IndexType numMerges() const { return _numConstMerges + _numEquivMerges; }
+        IndexType numConstMerges() const { return _numConstMerges; }
+        IndexType numEquivMerges() const { return _numEquivMerges; }
+        IndexType numRounds() const { return _numRounds; }
+        IndexType gatesBefore() const { return _gatesBefore; }
+        IndexType gatesAfter() const { return _gatesAfter; }
+        /// @brief whether the run exceeded the wall-clock budget or stopped before a fixed point because of it
+        bool outOfTime() const { return _outOfTime; }
+        RealType simTime() const { return _simTime; }
+        RealType satTime() const { return _satTime; }
+        RealType totalTime() const { return _totalTime; }
+
+        void addConstMerges(IndexType num) { _numConstMerges += num; }
+        void addEquivMerges(IndexType num) { _numEquivMerges += num; }
+        void setNumRounds(IndexType numRounds) { _numRounds = numRounds; }
+        void setGatesBefore(IndexType gates) { _gatesBefore = gates; }
+        void setGatesAfter(IndexType gates) { _gatesAfter = gates; }
+        void setOutOfTime(bool outOfTime) { _outOfTime = outOfTime; }
+        void addSimTime(RealType time) { _simTime += time; }
+        void addSatTime(RealType time) { _satTime += time; }
+        void setTotalTime(RealType time) { _totalTime = time; }
+    private:
+        IndexType _numConstMerges = 0; ///< Nodes proven constant
+        IndexType _numEquivMerges = 0; ///< Nodes proven equivalent to another node, up to complement
+        IndexType _numRounds = 0;      ///< Rounds of simulation and SAT sweeping
+        IndexType _gatesBefore = 0;    ///< Gates before the first round
+        IndexType _gatesAfter = 0;     ///< Gates after the last round
+        bool      _outOfTime = false;  ///< The wall-clock budget ran out or was exceeded
+        RealType  _simTime = 0;        ///< Seconds spent simulating
+        RealType  _satTime = 0;        ///< Seconds spent in the SAT solver
+        RealType  _totalTime = 0;      ///< Wall-clock seconds of the whole run
+};
 
 // object types
 typedef enum { 
@@ -82,21 +157,29 @@ class MigNode
         IntType fanin2() { AssertMsg(hasFanin2(), "The node does not has fanin 2!\n"); return _fanin2; }
         /// @brief Get number of fanouts
         /// @return number of fanouts
-        IntType numFanouts() { return _fanout_size; }
+        IntType numFanouts() { return _fanoutType >> NODE_TYPE_BITS; }
+        /// @brief Set number of fanouts. Saturates at 2^28 - 1
+        /// @param number of fanouts
+        void setNumFanouts(IndexType numFanouts)
+        {
+            numFanouts = std::min(numFanouts, MAX_FANOUTS);
+            _fanoutType = (numFanouts << NODE_TYPE_BITS) | (_fanoutType & NODE_TYPE_MASK);
+        }
         /// @brief Set the type of the node
         /// @param The type of the node. The type of defined in MigNodeType enum
-        void setNodeType(IntType nodeType) { _nodeType = nodeType; }
+        void setNodeType(IntType nodeType) { _fanoutType = (_fanoutType & ~NODE_TYPE_MASK) | (nodeType & NODE_TYPE_MASK); }
         /// @brief Get the type of the node
         /// @param The type of the node.
         IntType nodeType()
         {
-            AssertMsg(_nodeType != MIG_NODE_NUMBER, "Node type is unknown! \n");
-            return _nodeType;
+            IntType nodeType = _fanoutType & NODE_TYPE_MASK;
+            AssertMsg(nodeType != MIG_NODE_NUMBER, "Node type is unknown! \n");
+            return nodeType;
         }
         /// @brief Configure the node with Abc_Obj_t
         /// @param Pointer to Abc_Obj_t
         void configure(mockturtle::mig_network::signal a, mockturtle::mig_network::signal b, mockturtle::mig_network::signal c, IndexType num_fanouts, int type){
-            _fanout_size = num_fanouts;
+            this->setNumFanouts(num_fanouts);
             if(type == 0){ // Normal Node
                 _fanin0 = a.index;
                 _fanin1 = b.index;
@@ -148,22 +231,191 @@ class MigNode
             }
             else if(type == 4){ // Primary Input and Output
                 this->setNodeType(MIG_NODE_PIO);
+                // The storage node of a PI keeps its PI index in the children, these are not fanins
+                _fanin0 = _fanin1 = _fanin2 = -1;
             }
             else if(type == 5){ // Primary Input and Output
                 this->setNodeType(MIG_NODE_POC);
             }
         }
+        /// @brief Build a node, classified with the precedence of updateGraph: PI, then PO, then constant
+        /// @param the three fanin signals
+        /// @param number of fanouts
+        /// @param whether the node is a PI, and whether it drives a PO
+        /// @param the index of the node, 0 is the constant
+        /// @return the MigNode
+        static MigNode classify(mockturtle::mig_network::signal a, mockturtle::mig_network::signal b, mockturtle::mig_network::signal c,
+                IndexType num_fanouts, bool isPi, bool isPo, IndexType nodeIdx)
+        {
+            MigNode migNode;
+            if(isPi){
+                migNode.configure(a, b, c, num_fanouts, isPo ? 4 : 2);
+            }
+            else if(isPo){
+                migNode.configure(a, b, c, num_fanouts, nodeIdx == 0 ? 5 : 3);
+            }
+            else if(nodeIdx == 0){
+                migNode.configure(a, b, c, num_fanouts, 1);
+            }
+            else{
+                migNode.configure(a, b, c, num_fanouts, 0);
+            }
+            return migNode;
+        }
         
         // Find what class represents a node within mockturtle
         
 
     private:
+        static constexpr IndexType NODE_TYPE_BITS = 4;
+        static constexpr IndexType NODE_TYPE_MASK = (1u << NODE_TYPE_BITS) - 1;
+        static constexpr IndexType MAX_FANOUTS = (1u << (32 - NODE_TYPE_BITS)) - 1;
+
         IntType _fanin0 = -1; ///< The fanin 0. -1 if no fanin 0
         IntType _fanin1 = -1; ///< The fanin 1. -1 if no fanin 1
         IntType _fanin2 = -1; ///< The fanin 2. -1 if no fanin 2
-        IndexType _fanout_size = -1; ///< Total fanout nodes
-        IntType _nodeType = MIG_NODE_NUMBER; ///< The type of this node
+        IndexType _fanoutType = MIG_NODE_NUMBER; ///< Low 4 bits: the type of this node. High 28 bits: total fanout nodes
+};
+static_assert(MIG_NODE_NUMBER < 16, "MigNodeType must fit in the 4 type bits of MigNode");
+static_assert(sizeof(MigNode) == 16, "MigNode is expected to pack into 16 bytes");
+
+/// @class MTL_PY::MemoryStats
+/// @brief memory used by each structure of an interface, in bytes
+class MemoryStats
+{
+    public:
+        explicit MemoryStats() = default;
+        std::uint64_t migNodes() const { return _migNodes; }
+        std::uint64_t migHash() const { return _migHash; }
+        std::uint64_t migIo() const { return _migIo; }
+        std::uint64_t nodeView() const { return _nodeView; }
+        std::uint64_t lutCache() const { return _lutCache; }
+        std::uint64_t total() const { return _migNodes + _migHash + _migIo + _nodeView + _lutCache; }
+
+        void setMigNodes(std::uint64_t bytes) { _migNodes = bytes; }
+        void setMigHash(std::uint64_t bytes) { _migHash = bytes; }
+        void setMigIo(std::uint64_t bytes) { _migIo = bytes; }
+        void setNodeView(std::uint64_t bytes) { _nodeView = bytes; }
+        void setLutCache(std::uint64_t bytes) { _lutCache = bytes; }
+    private:
+        std::uint64_t _migNodes = 0; ///< mig_network node storage
+        std::uint64_t _migHash = 0;  ///< mig_network structural hash table
+        std::uint64_t _migIo = 0;    ///< mig_network input and output lists
+        std::uint64_t _nodeView = 0; ///< The MigNode mirror, or the PO mask in compact mode
+        std::uint64_t _lutCache = 0; ///< Cuts kept by map_qor, estimated
+};
+
+/// ================================================================================
+/// Flat layout of a MIG in a shared-memory segment
+///   MigShmHeader
+///   uint32 literals[numNodes][3]  fanins as 2 * index + complement, 0 for the constant and the PIs
+///   uint32 fanouts[numNodes]      fanout count of each node
+///   uint32 outputs[numPos]        PO literals
+///   uint8  flags[numNodes]        MIG_SHM_PI | MIG_SHM_PO
+/// The arrays start at 8-byte aligned offsets from the segment start. Gates
+/// only refer to lower indices, as in mig_network.
+/// ================================================================================
+struct MigShmHeader
+{
+    std::uint64_t magic;          ///< MIG_SHM_MAGIC, written last
+    std::uint32_t version;        ///< MIG_SHM_VERSION
+    std::uint32_t headerSize;     ///< sizeof(MigShmHeader)
+    std::uint64_t totalSize;      ///< Size of the whole layout
+    std::uint32_t numNodes;       ///< Including the constant and the PIs
+    std::uint32_t numPis;
+    std::uint32_t numPos;
+    std::uint32_t depth;
+    std::uint64_t literalsOffset;
+    std::uint64_t fanoutsOffset;
+    std::uint64_t outputsOffset;
+    std::uint64_t flagsOffset;
 };
+constexpr std::uint64_t MIG_SHM_MAGIC = 0x47494d59504c544dull; ///< "MTLPYMIG"
+constexpr std::uint32_t MIG_SHM_VERSION = 1;
+constexpr Byte MIG_SHM_PI = 1;
+constexpr Byte MIG_SHM_PO = 2;
+
+/// @class MTL_PY::MigShmView
+/// @brief Read-only view of a MIG exported to shared memory. Nothing is copied
+class MigShmView
+{
+    public:
+        explicit MigShmView() = default;
+        /// @brief map an exported MIG and validate its layout
+        /// @param the segment name
+        /// @return whether the segment holds a valid MIG
+        bool attach(const std::string &name);
+        /// @brief drop the mapping of this view. It is unmapped once the arrays sharing it are released too
+        void close() { _shm.reset(); _header = nullptr; }
+        bool isOpen() const { return _header != nullptr; }
+        IndexType numNodes() const { return _header->numNodes; }
+        IndexType numPis() const { return _header->numPis; }
+        IndexType numPos() const { return _header->numPos; }
+        IndexType depth() const { return _header->depth; }
+        const std::uint32_t * literals() const { return reinterpret_cast<const std::uint32_t *>(_shm->data() + _header->literalsOffset); }
+        const std::uint32_t * fanouts() const { return reinterpret_cast<const std::uint32_t *>(_shm->data() + _header->fanoutsOffset); }
+        const std::uint32_t * outputs() const { return reinterpret_cast<const std::uint32_t *>(_shm->data() + _header->outputsOffset); }
+        const Byte * flags() const { return reinterpret_cast<const Byte *>(_shm->data() + _header->flagsOffset); }
+        /// @brief the mapping, shared with whoever must keep the arrays valid
+        std::shared_ptr<const SharedMemory> mapping() const { return _shm; }
+        /// @brief Get one MigNode, configured as updateGraph would
+        /// @param The index of MigNode
+        /// @return The MigNode
+        MigNode migNode(IndexType nodeIdx) const;
+
+    private:
+        std::shared_ptr<SharedMemory> _shm;     ///< The mapped segment, shared with the numpy arrays
+        const MigShmHeader * _header = nullptr; ///< Start of the segment once validated
+};
+
+bool MigShmView::attach(const std::string &name)
+{
+    this->close();
+    _shm = std::make_shared<SharedMemory>();
+    if(!_shm->attach(name)){
+        _shm.reset();
+        return false;
+    }
+    auto const *header = reinterpret_cast<const MigShmHeader *>(_shm->data());
+    // Pairs with the release in export_shm: once the magic is seen, the whole layout is
+    if(_shm->size() < sizeof(MigShmHeader)
+            || reinterpret_cast<const std::atomic<std::uint64_t> *>(_shm->data())->load(std::memory_order_acquire) != MIG_SHM_MAGIC){
+        ERR("Shared memory %s does not hold an exported MIG\n", name.c_str());
+        _shm.reset();
+        return false;
+    }
+    if(header->version != MIG_SHM_VERSION || header->headerSize != sizeof(MigShmHeader)){
+        ERR("Shared memory %s: unsupported layout version %u\n", name.c_str(), header->version);
+        _shm.reset();
+        return false;
+    }
+    auto fits = [&](std::uint64_t offset, std::uint64_t bytes){
+        return offset % 8 == 0 && offset <= header->totalSize && bytes <= header->totalSize - offset;
+    };
+    const std::uint64_t numNodes = header->numNodes;
+    if(header->totalSize > _shm->size() || numNodes == 0 || header->numPis >= numNodes
+            || !fits(header->literalsOffset, 3 * numNodes * sizeof(std::uint32_t))
+            || !fits(header->fanoutsOffset, numNodes * sizeof(std::uint32_t))
+            || !fits(header->outputsOffset, header->numPos * sizeof(std::uint32_t))
+            || !fits(header->flagsOffset, numNodes)){
+        ERR("Shared memory %s: truncated MIG layout\n", name.c_str());
+        _shm.reset();
+        return false;
+    }
+    _header = header;
+    return true;
+}
+
+MigNode MigShmView::migNode(IndexType nodeIdx) const
+{
+    AssertMsg(nodeIdx < this->numNodes(), "Access node out of range %u / %u \n", nodeIdx, this->numNodes());
+    auto const *lits = this->literals() + 3 * static_cast<std::size_t>(nodeIdx);
+    mockturtle::mig_network::signal ch0(lits[0] >> 1, lits[0] & 1);
+    mockturtle::mig_network::signal ch1(lits[1] >> 1, lits[1] & 1);
+    mockturtle::mig_network::signal ch2(lits[2] >> 1, lits[2] & 1);
+    const Byte flags = this->flags()[nodeIdx];
+    return MigNode::classify(ch0, ch1, ch2, this->fanouts()[nodeIdx], flags & MIG_SHM_PI, flags & MIG_SHM_PO, nodeIdx);
+}
 
 /// @class MTL_PY::MtlInterface
 /// @brief the interface to ABC
@@ -184,10 +436,30 @@ class MtlInterface
         /// @param filename
         /// @return Time taken to perform the read
         float read_verilog(const std::string & filename);
+        /// @brief read a binary AIG file through a memory mapping, decoding the AND section in parallel
+        /// @param filename
+        /// @param number of decoding threads. 0 uses the OpenMP default
+        /// @return Wall-clock time taken to perform the read
+        float read_aig_mmap(const std::string & filename, IndexType num_threads);
+        /// @brief read a Verilog file through a memory mapping
+        /// @param filename
+        /// @return Wall-clock time taken to perform the read
+        float read_verilog_mmap(const std::string & filename);
+        /// @brief get the stats of the last memory-mapped read
+        /// @return the LoadStats
+        LoadStats loadStats() const { return _loadStats; }
         /// @brief Write a Verilog file
         /// @param filename
         /// @return Time taken to perform the write
         float write_verilog(const std::string & filename);
+        /// @brief export the MIG into a POSIX shared-memory segment, replacing any segment of that name
+        /// @param the segment name
+        /// @return Wall-clock time taken to perform the export
+        float export_shm(const std::string & name);
+        /// @brief replace the MIG by the one exported into a shared-memory segment, with a bulk copy
+        /// @param the segment name
+        /// @return Wall-clock time taken to perform the import
+        float import_shm(const std::string & name);
         /*------------------------------*/ 
         /* Perform Logic Synthesis      */
         /*------------------------------*/
@@ -203,6 +475,17 @@ class MtlInterface
         /// @brief Perform resubstitution on the MIG
         /// @return the time taken to perform resubstitution
         float resub(IndexType max_pis, IndexType max_inserts, bool use_dont_cares, IndexType window_size, bool preserve_depth);
+        /// @brief Merge functionally equivalent nodes, proven with SAT on the candidates found by simulation
+        /// Rounds are repeated until no merge is found, the round limit or the wall-clock budget
+        /// @param the wall-clock budget in seconds. 0 for no limit. It is checked between rounds and the SAT
+        ///        limits of a round shrink with the budget left, but the first round always runs in full
+        ///        and the simulation of a round is not bounded, so a large design can exceed it
+        /// @param the conflict limit of each SAT call
+        /// @param the maximum number of rounds
+        /// @param the maximum number of nodes in the transitive fanin encoded for one SAT call
+        /// @param nodes with more fanouts are not merged
+        /// @return the merge counts and the time breakdown
+        FraigStats fraig(RealType time_limit, IndexType conflict_limit, IndexType max_rounds, IndexType max_tfi_nodes, IndexType skip_fanout_limit);
         /*------------------------------*/ 
         /* Query the information        */
         /*------------------------------*/ 
@@ -216,16 +499,81 @@ class MtlInterface
             IntType nObj = _mig.size();
             return nObj;
         }
+        /// @brief get the number of MIG gates
+        /// @return the number of gates
+        IndexType numGates() const { return _mig.num_gates(); }
+        /// @brief compute the depth of the MIG
+        /// @return the depth
+        IndexType depth() const;
+        /// @brief compute the structural hash of the MIG. Equal for structurally identical designs
+        /// @return the hash
+        std::uint64_t structuralHash() const;
+        /// @brief map the MIG into k-LUTs and report the QoR
+        /// The cuts are cached between calls, only the regions changed since the last call are enumerated
+        /// @param the LUT size
+        /// @param use mockturtle lut_mapping instead of the incremental estimator
+        /// @return the LUT count and depth
+        MapQor map_qor(IndexType k, bool exact);
+        /// @brief drop the cuts cached by map_qor and release its scratch
+        void clear_qor_cache() { _lutQor.clear(); }
+        /// @brief get the number of nodes of the node view: as of the last updateGraph, or of the live network in compact mode
+        /// @return the number of nodes accessible with migNode
+        IndexType numViewNodes() const
+        {
+            if(_compact){
+                return _mig.size();
+            }
+            return _migNodes.size();
+        }
         /// @brief update the graph
         void updateGraph();
         /// @brief Get one MigNode
         /// @param The index of MigNode
         /// @return The MigNode
-        MigNode & migNode(IntType nodeIdx) 
+        MigNode migNode(IntType nodeIdx) 
         { 
-            AssertMsg(nodeIdx < this->numNodes(), "Access node out of range %d / %d \n", nodeIdx, this->numNodes()); 
+            AssertMsg(nodeIdx >= 0 && static_cast<IndexType>(nodeIdx) < this->numViewNodes(), "Access node out of range %d / %u \n", nodeIdx, this->numViewNodes()); 
+            if(_compact){
+                this->syncCompactView();
+                return this->deriveMigNode(nodeIdx);
+            }
+            if(nodeIdx < 0 || static_cast<std::size_t>(nodeIdx) >= _migNodes.size()){
+                return MigNode();
+            }
             return _migNodes[nodeIdx]; 
         }
+        /// @brief In compact mode, rebuild the PO mask if the network changed since it was built
+        /// Called by migNode. Call it before reading the nodes from several threads
+        void syncCompactView();
+        /// @brief In compact mode, updateGraph keeps no MigNode mirror and migNode derives nodes from the mig_network storage
+        /// @param whether to turn on the compact mode
+        void setCompactMode(bool compact) { _compact = compact; this->updateGraph(); }
+        /// @brief whether the compact mode is on
+        bool compactMode() const { return _compact; }
+        /// @brief get the memory used by each structure
+        /// @return the MemoryStats
+        MemoryStats memoryStats() const;
+
+        /*------------------------------*/ 
+        /* Recipe search                */
+        /*------------------------------*/ 
+        /// @brief deep copy of the design, without the node mirror
+        /// Only reads the design, so concurrent snapshots of one design are safe
+        /// @return the copy
+        MtlInterface snapshot() const;
+        /// @brief apply one synthesis action
+        void applyAction(const SearchAction &action);
+        /// @brief search a recipe from the current design. The design itself is not modified
+        /// @param the action set
+        /// @param the budget and objective
+        /// @return the best recipe and the Pareto front
+        SearchResult search(const std::vector<SearchAction> &actions, const SearchParams &params) const;
+
+    private:
+        /// @brief build one MigNode from the mig_network storage, as updateGraph would
+        MigNode deriveMigNode(IndexType nodeIdx) const;
+        /// @brief mark the POs of the live network in _poMask
+        void buildPoMask();
 
     private:
         mockturtle::mig_network _mig;
@@ -237,6 +585,12 @@ class MtlInterface
         IntType _numPO = -1; ///< Number of POs of the MIG network
         IntType _numConst = -1; ///< Number of CONST of the MIG network
         std::vector<MigNode> _migNodes; ///< The current MIG network nodes
+        bool _compact = false; ///< Derive the nodes lazily instead of keeping _migNodes
+        std::vector<bool> _poMask; ///< Compact mode: whether a node drives a PO
+        std::weak_ptr<mockturtle::mig_storage> _poMaskStorage; ///< Compact mode: the storage _poMask was built from
+        IndexType _poMaskPos = 0; ///< Compact mode: the number of POs when _poMask was built
+        LoadStats _loadStats; ///< Stats of the last memory-mapped read
+        LutQorEstimator _lutQor; ///< Incremental LUT mapper, keeps the cuts of the last call
 };
 
 PROJECT_NAMESPACE_END
@@ -259,6 +613,7 @@ void MtlInterface::end(){
 
 float MtlInterface::read_aig(const std::string &filename)
 {
+    MTL_TRACE_SPAN(OP, "read_aig");
     if(!_interface){
         return -1.0;
     }
@@ -275,6 +630,7 @@ float MtlInterface::read_aig(const std::string &filename)
 
 float MtlInterface::read_verilog(const std::string &filename)
 {
+    MTL_TRACE_SPAN(OP, "read_verilog");
     if(!_interface){
         return -1.0;
     }
@@ -289,8 +645,96 @@ float MtlInterface::read_verilog(const std::string &filename)
     return (float)_lastClk/CLOCKS_PER_SEC;
 }
 
+float MtlInterface::read_aig_mmap(const std::string &filename, IndexType num_threads)
+{
+    MTL_TRACE_SPAN(OP, "read_aig_mmap");
+    if(!_interface){
+        return -1.0;
+    }
+    auto beginTime = std::chrono::steady_clock::now();
+    MmapFile file;
+    if(!file.open(filename)){
+        return -1.0;
+    }
+    AigerData aig;
+    AigerParser parser;
+    parser.setNumThreads(num_threads);
+    if(!parser.parse(file.data(), file.size(), aig)){
+        ERR("Failed to read AIGER file %s\n", filename.c_str());
+        return -1.0;
+    }
+    auto parseTime = std::chrono::steady_clock::now();
+
+    {
+        MTL_TRACE_SPAN(DETAIL, "read_aig_mmap::build");
+        // Reserve everything up front, the gates are then appended without any reallocation
+        _mig._storage->nodes.reserve(_mig.size() + aig.numInputs() + aig.numAnds());
+        _mig._storage->inputs.reserve(_mig.num_pis() + aig.numInputs());
+        _mig._storage->outputs.reserve(_mig.num_pos() + aig.numOutputs());
+        _mig._storage->hash.reserve(_mig._storage->hash.size() + aig.numAnds());
+
+        // Signal of every AIGER variable. Variable 0 is the constant
+        std::vector<mockturtle::mig_network::signal> signals;
+        signals.reserve(1 + aig.numInputs() + aig.numAnds());
+        signals.emplace_back(_mig.get_constant(false));
+        for(IndexType i = 0; i < aig.numInputs(); ++i){
+            signals.emplace_back(_mig.create_pi());
+        }
+        auto toSignal = [&](IndexType lit){
+            auto sig = signals[lit >> 1];
+            return (lit & 1) ? _mig.create_not(sig) : sig;
+        };
+        for(IndexType i = 0; i < aig.numAnds(); ++i){
+            signals.emplace_back(_mig.create_and(toSignal(aig.and0(i)), toSignal(aig.and1(i))));
+        }
+        for(IndexType i = 0; i < aig.numOutputs(); ++i){
+            _mig.create_po(toSignal(aig.output(i)));
+        }
+    }
+    auto endTime = std::chrono::steady_clock::now();
+
+    _loadStats.setNumBytes(file.size());
+    _loadStats.setParseTime(std::chrono::duration<RealType>(parseTime - beginTime).count());
+    _loadStats.setBuildTime(std::chrono::duration<RealType>(endTime - parseTime).count());
+    _loadStats.setTotalTime(std::chrono::duration<RealType>(endTime - beginTime).count());
+    _lastClk = _loadStats.totalTime() * CLOCKS_PER_SEC;
+    MTL_TRACE_INSTANT(DETAIL, "read_aig_mmap::stats", filename + ": " + std::to_string(_loadStats.mbPerSec()) + " MB/s");
+    this->updateGraph();
+    return _loadStats.totalTime();
+}
+
+float MtlInterface::read_verilog_mmap(const std::string &filename)
+{
+    MTL_TRACE_SPAN(OP, "read_verilog_mmap");
+    if(!_interface){
+        return -1.0;
+    }
+    auto beginTime = std::chrono::steady_clock::now();
+    MmapFile file;
+    if(!file.open(filename)){
+        return -1.0;
+    }
+    MmapStreamBuf buffer(file);
+    std::istream in(&buffer);
+    if(lorina::read_verilog(in, mockturtle::verilog_reader( _mig )) != lorina::return_code::success){
+        ERR("Failed to read Verilog file %s\n", filename.c_str());
+        return -1.0;
+    }
+    auto endTime = std::chrono::steady_clock::now();
+
+    _loadStats.setNumBytes(file.size());
+    _loadStats.setParseTime(std::chrono::duration<RealType>(endTime - beginTime).count());
+    _loadStats.setBuildTime(0.0); // Interleaved with the parsing
+    _loadStats.setTotalTime(_loadStats.parseTime());
+    _lastClk = _loadStats.totalTime() * CLOCKS_PER_SEC;
+    MTL_TRACE_INSTANT(DETAIL, "read_verilog_mmap::stats", filename + ": " + std::to_string(_loadStats.mbPerSec()) + " MB/s");
+    this->updateGraph();
+    return _loadStats.totalTime();
+}
+
 float MtlInterface::write_verilog(const std::string &filename)
 {
+    MTL_TRACE_SPAN(OP, "write_verilog");
     if(!_interface){
         return -1.0;
     }
@@ -304,7 +748,136 @@ float MtlInterface::write_verilog(const std::string &filename)
     return (float)_lastClk/CLOCKS_PER_SEC;
 }
 
+float MtlInterface::export_shm(const std::string &name)
+{
+    MTL_TRACE_SPAN(OP, "export_shm");
+    if(!_interface){
+        return -1.0;
+    }
+    auto beginTime = std::chrono::steady_clock::now();
+    auto align = [](std::uint64_t offset){ return (offset + 7) & ~std::uint64_t(7); };
+    const std::int64_t numNodes = _mig.size();
+    const std::uint64_t numPos = _mig.num_pos();
+    MigShmHeader layout{};
+    layout.literalsOffset = align(sizeof(MigShmHeader));
+    layout.fanoutsOffset = align(layout.literalsOffset + 3 * numNodes * sizeof(std::uint32_t));
+    layout.outputsOffset = align(layout.fanoutsOffset + numNodes * sizeof(std::uint32_t));
+    layout.flagsOffset = align(layout.outputsOffset + numPos * sizeof(std::uint32_t));
+    layout.totalSize = layout.flagsOffset + numNodes;
+    SharedMemory shm;
+    if(!shm.create(name, layout.totalSize)){
+        return -1.0;
+    }
+    layout.version = MIG_SHM_VERSION;
+    layout.headerSize = sizeof(MigShmHeader);
+    layout.numNodes = numNodes;
+    layout.numPis = _mig.num_pis();
+    layout.numPos = numPos;
+
+    auto *literals = reinterpret_cast<std::uint32_t *>(shm.data() + layout.literalsOffset);
+    auto *fanouts = reinterpret_cast<std::uint32_t *>(shm.data() + layout.fanoutsOffset);
+    auto *outputs = reinterpret_cast<std::uint32_t *>(shm.data() + layout.outputsOffset);
+    auto *flags = reinterpret_cast<Byte *>(shm.data() + layout.flagsOffset);
+    auto const &nodes = _mig._storage->nodes;
+    #pragma omp parallel for schedule(static)
+    for(std::int64_t i = 0; i < numNodes; ++i){
+        auto node = _mig.index_to_node(i);
+        const bool isPi = _mig.is_pi(node);
+        for(IndexType k = 0; k < 3; ++k){
+            // The storage node of a PI keeps its PI index in the children, these are not fanins
+            literals[3 * i + k] = (i == 0 || isPi) ? 0 : 2 * nodes[i].children[k].index + nodes[i].children[k].weight;
+        }
+        fanouts[i] = _mig.fanout_size(node);
+        flags[i] = isPi ? MIG_SHM_PI : 0;
+    }
+    // Levels as in depth_view: the gates are in topological order
+    std::vector<std::uint32_t> level(numNodes, 0);
+    for(std::int64_t i = 1; i < numNodes; ++i){
+        if(!(flags[i] & MIG_SHM_PI)){
+            level[i] = 1 + std::max({level[literals[3 * i] >> 1], level[literals[3 * i + 1] >> 1], level[literals[3 * i + 2] >> 1]});
+        }
+    }
+    std::uint64_t po = 0;
+    _mig.foreach_po([&](auto const &f){
+        const auto idx = _mig.node_to_index(_mig.get_node(f));
+        outputs[po++] = 2 * idx + (_mig.is_complemented(f) ? 1 : 0);
+        flags[idx] |= MIG_SHM_PO;
+        layout.depth = std::max(layout.depth, level[idx]);
+    });
+
+    // A reader that sees the magic sees the complete layout
+    layout.magic = MIG_SHM_MAGIC;
+    std::memcpy(shm.data() + sizeof(layout.magic), reinterpret_cast<const char *>(&layout) + sizeof(layout.magic),
+            sizeof(MigShmHeader) - sizeof(layout.magic));
+    std::atomic_thread_fence(std::memory_order_release);
+    reinterpret_cast<std::atomic<std::uint64_t> *>(shm.data())->store(layout.magic, std::memory_order_relaxed);
+    auto endTime = std::chrono::steady_clock::now();
+    RealType time = std::chrono::duration<RealType>(endTime - beginTime).count();
+    _lastClk = time * CLOCKS_PER_SEC;
+    MTL_TRACE_INSTANT(DETAIL, "export_shm::stats", name + ": " + std::to_string(numNodes) + " nodes, "
+            + std::to_string(layout.totalSize) + " bytes");
+    return time;
+}
+
+float MtlInterface::import_shm(const std::string &name)
+{
+    MTL_TRACE_SPAN(OP, "import_shm");
+    if(!_interface){
+        return -1.0;
+    }
+    auto beginTime = std::chrono::steady_clock::now();
+    MigShmView view;
+    if(!view.attach(name)){
+        return -1.0;
+    }
+    const IndexType numNodes = view.numNodes();
+    auto const *literals = view.literals();
+    auto const *flags = view.flags();
+    auto const *outputs = view.outputs();
+
+    // Append the storage nodes directly: the exporter is a valid mig_network,
+    // so create_maj would neither normalize nor find structural duplicates
+    mockturtle::mig_network mig;
+    auto &storage = *mig._storage;
+    storage.nodes.reserve(numNodes);
+    storage.inputs.reserve(view.numPis());
+    storage.outputs.reserve(view.numPos());
+    storage.hash.reserve(numNodes - view.numPis() - 1);
+    for(IndexType i = 1; i < numNodes; ++i){
+        if(flags[i] & MIG_SHM_PI){
+            mig.create_pi();
+            continue;
+        }
+        auto const *lits = literals + 3 * static_cast<std::size_t>(i);
+        if((lits[0] >> 1) >= i || (lits[1] >> 1) >= i || (lits[2] >> 1) >= i){
+            ERR("Shared memory %s: node %u is not in topological order\n", name.c_str(), i);
+            return -1.0;
+        }
+        auto &node = storage.nodes.emplace_back();
+        for(IndexType k = 0; k < 3; ++k){
+            node.children[k].index = lits[k] >> 1;
+            node.children[k].weight = lits[k] & 1;
+            storage.nodes[lits[k] >> 1].data[0].h1++;
+        }
+        storage.hash[node] = i;
+    }
+    for(IndexType i = 0; i < view.numPos(); ++i){
+        if((outputs[i] >> 1) >= numNodes){
+            ERR("Shared memory %s: output %u refers to node %u beyond %u\n", name.c_str(), i, outputs[i] >> 1, numNodes);
+            return -1.0;
+        }
+        mig.create_po(mockturtle::mig_network::signal(outputs[i] >> 1, outputs[i] & 1));
+    }
+    _mig = mig;
+    auto endTime = std::chrono::steady_clock::now();
+    RealType time = std::chrono::duration<RealType>(endTime - beginTime).count();
+    _lastClk = time * CLOCKS_PER_SEC;
+    this->updateGraph();
+    return time;
+}
+
 float MtlInterface::balance(bool crit, IndexType cut_size){
+    MTL_TRACE_SPAN(OP, "balance");
     if(!_interface){
         return -1.0;
     }
@@ -320,6 +893,7 @@ float MtlInterface::balance(bool crit, IndexType cut_size){
 }
 
 float MtlInterface::rewrite(bool allow_zero_gain, bool use_dont_cares, bool preserve_depth, IndexType min_cut_size){
+    MTL_TRACE_SPAN(OP, "rewrite");
     if(!_interface){
         return -1.0;
     }
@@ -331,12 +905,19 @@ float MtlInterface::rewrite(bool allow_zero_gain, bool use_dont_cares, bool pres
     ps.allow_zero_gain = allow_zero_gain;
     ps.use_dont_cares = use_dont_cares;
     ps.preserve_depth = preserve_depth;
-    _mig = mockturtle::cut_rewriting( _mig, resyn, ps, &st );
-    _mig = mockturtle::cleanup_dangling( _mig );
+    {
+        MTL_TRACE_SPAN(DETAIL, "rewrite::cut_rewriting");
+        _mig = mockturtle::cut_rewriting( _mig, resyn, ps, &st );
+    }
+    {
+        MTL_TRACE_SPAN(DETAIL, "rewrite::cleanup_dangling");
+        _mig = mockturtle::cleanup_dangling( _mig );
+    }
     return mockturtle::to_seconds(st.time_total);
 }
 
 float MtlInterface::refactor(bool allow_zero_gain, bool use_dont_cares){
+    MTL_TRACE_SPAN(OP, "refactor");
     if(!_interface){
         return -1.0;
     }
@@ -345,14 +926,19 @@ float MtlInterface::refactor(bool allow_zero_gain, bool use_dont_cares){
     mockturtle::refactoring_stats st;
     ps.allow_zero_gain = allow_zero_gain;
     ps.use_dont_cares = use_dont_cares;
-    std::cout << "Reached refactoring part.\n";
-    mockturtle::refactoring( _mig, resyn, ps, &st);
-    std::cout << "Finished refactoring.\n";
-    _mig = mockturtle::cleanup_dangling( _mig );
+    {
+        MTL_TRACE_SPAN(DETAIL, "refactor::refactoring");
+        mockturtle::refactoring( _mig, resyn, ps, &st);
+    }
+    {
+        MTL_TRACE_SPAN(DETAIL, "refactor::cleanup_dangling");
+        _mig = mockturtle::cleanup_dangling( _mig );
+    }
     return mockturtle::to_seconds(st.time_total);
 }
 
 float MtlInterface::resub(IndexType max_pis, IndexType max_inserts, bool use_dont_cares, IndexType window_size, bool preserve_depth){
+    MTL_TRACE_SPAN(OP, "resub");
     if(!_interface){
         return -1.0;
     }
@@ -365,24 +951,97 @@ float MtlInterface::resub(IndexType max_pis, IndexType max_inserts, bool use_don
     ps.preserve_depth = preserve_depth;
     mockturtle::depth_view _depth_mig{ _mig }; 
     mockturtle::fanout_view _fanout_mig{ _depth_mig };
-    std::cout << "Reached resubstitution part.\n";
-    mockturtle::mig_resubstitution( _fanout_mig, ps, &st );
-    std::cout << "Finished resubstitution.\n";
-    _mig = mockturtle::cleanup_dangling( _mig );
+    {
+        MTL_TRACE_SPAN(DETAIL, "resub::mig_resubstitution");
+        mockturtle::mig_resubstitution( _fanout_mig, ps, &st );
+    }
+    {
+        MTL_TRACE_SPAN(DETAIL, "resub::cleanup_dangling");
+        _mig = mockturtle::cleanup_dangling( _mig );
+    }
     return mockturtle::to_seconds(st.time_total);
 }
 
+FraigStats MtlInterface::fraig(RealType time_limit, IndexType conflict_limit, IndexType max_rounds, IndexType max_tfi_nodes, IndexType skip_fanout_limit)
+{
+    MTL_TRACE_SPAN(OP, "fraig");
+    FraigStats stats;
+    if(!_interface){
+        return stats;
+    }
+    auto beginTime = std::chrono::steady_clock::now();
+    mockturtle::functional_reduction_params ps;
+    // One iteration per round so that the budget is checked between them
+    ps.max_iterations = 1;
+    RealType lastRound = 0.0;
+    ps.conflict_limit = conflict_limit;
+    ps.max_TFI_nodes = max_tfi_nodes;
+    ps.skip_fanout_limit = skip_fanout_limit;
+    stats.setGatesBefore(_mig.num_gates());
+    IndexType round = 0;
+    while(max_rounds == 0 || round < max_rounds){
+        RealType elapsed = std::chrono::duration<RealType>(std::chrono::steady_clock::now() - beginTime).count();
+        if(time_limit > 0 && elapsed >= time_limit){
+            stats.setOutOfTime(true);
+            break;
+        }
+        if(time_limit > 0 && lastRound > 0){
+            // Scale the SAT work of the round to the budget left, as measured on the previous round
+            RealType ratio = std::min<RealType>(1.0, (time_limit - elapsed) / lastRound);
+            ps.conflict_limit = std::max<IndexType>(1, static_cast<IndexType>(ps.conflict_limit * ratio));
+            ps.max_TFI_nodes = std::max<IndexType>(16, static_cast<IndexType>(ps.max_TFI_nodes * ratio));
+        }
+        auto roundBegin = std::chrono::steady_clock::now();
+        mockturtle::functional_reduction_stats st;
+        {
+            MTL_TRACE_SPAN(DETAIL, "fraig::functional_reduction");
+            mockturtle::functional_reduction( _mig, ps, &st );
+        }
+        {
+            MTL_TRACE_SPAN(DETAIL, "fraig::cleanup_dangling");
+            _mig = mockturtle::cleanup_dangling( _mig );
+        }
+        ++round;
+        lastRound = std::chrono::duration<RealType>(std::chrono::steady_clock::now() - roundBegin).count();
+        stats.addConstMerges(st.num_const_accepts);
+        stats.addEquivMerges(st.num_equ_accepts);
+        stats.addSimTime(mockturtle::to_seconds(st.time_sim));
+        stats.addSatTime(mockturtle::to_seconds(st.time_sat));
+        if(st.num_const_accepts + st.num_equ_accepts == 0){
+            break;
+        }
+    }
+    stats.setNumRounds(round);
+    stats.setGatesAfter(_mig.num_gates());
+    stats.setTotalTime(std::chrono::duration<RealType>(std::chrono::steady_clock::now() - beginTime).count());
+    if(time_limit > 0 && stats.totalTime() > time_limit){
+        stats.setOutOfTime(true);
+    }
+    _lastClk = stats.totalTime() * CLOCKS_PER_SEC;
+    return stats;
+}
+
 void MtlInterface::updateGraph()
 {
+    MTL_TRACE_SPAN(OP, "updateGraph");
     _numMigNodes = _mig.size();
     mockturtle::depth_view mig_depth{ _mig };
     _depth = mig_depth.depth();
     _numPO = _mig.num_pos();
     _numPI = _mig.num_pis();
     _numConst = 0;
-    _migNodes.resize(_numMigNodes);
 
-    std::vector <IntType> visited(_numMigNodes, 0);
+    if(_compact){
+        // Only one bit per node is kept, the nodes are derived on access
+        std::vector<MigNode>().swap(_migNodes);
+        this->buildPoMask();
+        return;
+    }
+    std::vector<bool>().swap(_poMask);
+    _poMaskStorage.reset();
+    _migNodes.assign(_numMigNodes, MigNode());
+
+    std::vector <Byte> visited(_numMigNodes, 0);
 
     //Configure Primary Outputs
     _mig.foreach_po( [&](auto node){
@@ -436,8 +1095,152 @@ void MtlInterface::updateGraph()
 
 }
 
+void MtlInterface::buildPoMask()
+{
+    _poMask.assign(_mig.size(), false);
+    _mig.foreach_po( [&](auto node){
+        _poMask[node.index] = true;
+    });
+    _poMaskStorage = _mig._storage;
+    _poMaskPos = _mig.num_pos();
+}
+
+void MtlInterface::syncCompactView()
+{
+    if(!_compact){
+        return;
+    }
+    // The ops replace the storage, the readers append to it. The weak_ptr keeps the
+    // control block alive, so a new storage never compares equal to a freed one
+    bool sameStorage = !_poMaskStorage.owner_before(_mig._storage) && !_mig._storage.owner_before(_poMaskStorage);
+    if(!sameStorage || _poMask.size() != _mig.size() || _poMaskPos != _mig.num_pos()){
+        this->buildPoMask();
+    }
+}
+
+MigNode MtlInterface::deriveMigNode(IndexType nodeIdx) const
+{
+    if(nodeIdx >= _mig.size()){
+        return MigNode();
+    }
+    auto const &children = _mig._storage->nodes[nodeIdx].children;
+    mockturtle::mig_network::signal ch0 = mockturtle::mig_network::signal(children[0]);
+    mockturtle::mig_network::signal ch1 = mockturtle::mig_network::signal(children[1]);
+    mockturtle::mig_network::signal ch2 = mockturtle::mig_network::signal(children[2]);
+    auto node = _mig.index_to_node(nodeIdx);
+    IndexType num_fanout = _mig.fanout_size(node);
+    bool isPo = nodeIdx < _poMask.size() && _poMask[nodeIdx];
+    return MigNode::classify(ch0, ch1, ch2, num_fanout, _mig.is_pi(node), isPo, nodeIdx);
+}
+
+MemoryStats MtlInterface::memoryStats() const
+{
+    MemoryStats stats;
+    auto const &storage = *_mig._storage;
+    using HashEntry = typename std::decay_t<decltype(storage.hash)>::value_type;
+    stats.setMigNodes(storage.nodes.capacity() * sizeof(storage.nodes[0]));
+    // A flat open-addressing table: one slot and one control byte per capacity, plus one group of sentinel bytes
+    const std::uint64_t hashCapacity = storage.hash.capacity();
+    stats.setMigHash(hashCapacity == 0 ? 0 : hashCapacity * (sizeof(HashEntry) + 1) + 16);
+    stats.setMigIo(storage.inputs.capacity() * sizeof(storage.inputs[0]) + storage.outputs.capacity() * sizeof(storage.outputs[0]));
+    stats.setNodeView(_migNodes.capacity() * sizeof(MigNode) + _poMask.capacity() / 8);
+    stats.setLutCache(_lutQor.memoryBytes());
+    return stats;
+}
+
+MapQor MtlInterface::map_qor(IndexType k, bool exact)
+{
+    MTL_TRACE_SPAN(OP, "map_qor");
+    if(!_interface){
+        return MapQor();
+    }
+    if(!exact){
+        return _lutQor.run(_mig, k);
+    }
+    auto beginTime = std::chrono::steady_clock::now();
+    mockturtle::mapping_view<mockturtle::mig_network, true> mapped{ _mig };
+    mockturtle::lut_mapping_params ps;
+    ps.cut_enumeration_ps.cut_size = k;
+    mockturtle::lut_mapping<decltype(mapped), true>( mapped, ps );
+
+    // LUT levels over the cover, gates are visited in topological order
+    std::vector<IndexType> level(_mig.size(), 0);
+    _mig.foreach_gate( [&](auto node){
+        if(!mapped.is_cell_root(node)){
+            return;
+        }
+        IndexType lev = 0;
+        mapped.foreach_cell_fanin(node, [&](auto fanin){
+            lev = std::max(lev, level[_mig.node_to_index(fanin)]);
+        });
+        level[_mig.node_to_index(node)] = lev + 1;
+    });
+    IndexType lutDepth = 0;
+    _mig.foreach_po( [&](auto po){
+        lutDepth = std::max(lutDepth, level[_mig.node_to_index(_mig.get_node(po))]);
+    });
+
+    MapQor qor;
+    qor.setLutCount(mapped.num_cells());
+    qor.setLutDepth(lutDepth);
+    qor.setNumComputed(_mig.num_gates());
+    qor.setTime(std::chrono::duration<RealType>(std::chrono::steady_clock::now() - beginTime).count());
+    return qor;
+}
+
+IndexType MtlInterface::depth() const
+{
+    mockturtle::depth_view mig_depth{ _mig };
+    return mig_depth.depth();
+}
+
+std::uint64_t MtlInterface::structuralHash() const
+{
+    return PROJECT_NAMESPACE::structuralHash(_mig);
+}
+
+MtlInterface MtlInterface::snapshot() const
+{
+    MtlInterface copy;
+    copy._interface = _interface;
+    // Copying mig_network would share the storage. cleanup_dangling would give a private one,
+    // but its traversal marks the source storage, which races with the other snapshots of it
+    copy._mig = mockturtle::mig_network( std::make_shared<mockturtle::mig_storage>( *_mig._storage ) );
+    return copy;
+}
+
+void MtlInterface::applyAction(const SearchAction &action)
+{
+    switch (action.op())
+    {
+        case SearchOp::BALANCE:
+            this->balance(action.crit(), action.cutSize());
+            break;
+        case SearchOp::REWRITE:
+            this->rewrite(action.allowZeroGain(), action.useDontCares(), action.preserveDepth(), action.minCutSize());
+            break;
+        case SearchOp::REFACTOR:
+            this->refactor(action.allowZeroGain(), action.useDontCares());
+            break;
+        case SearchOp::RESUB:
+            this->resub(action.maxPis(), action.maxInserts(), action.useDontCares(), action.windowSize(), action.preserveDepth());
+            break;
+    }
+}
+
+SearchResult MtlInterface::search(const std::vector<SearchAction> &actions, const SearchParams &params) const
+{
+    MTL_TRACE_SPAN(OP, "search");
+    if(!_interface){
+        return SearchResult();
+    }
+    RecipeSearch<MtlInterface> engine(actions, params);
+    return engine.run(*this);
+}
+
 MigStats MtlInterface::migStats()
 {
+    MTL_TRACE_SPAN(OP, "migStats");
     this->updateGraph();
     MigStats stats;
     stats.setNumIn(_numPI);
@@ -451,8 +1254,174 @@ PROJECT_NAMESPACE_END
 
 
 namespace py = pybind11;
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MTL_PY::MigBatchCollator
+/// @brief Collate the node views of several interfaces into one disjoint-union graph
+/// The output arrays are owned by the collator and reused between calls: the
+/// arrays returned by collate are views, overwritten by the next call.
+class MigBatchCollator
+{
+    public:
+        /// @brief number of node features: one-hot node type, then the number of fanouts
+        static constexpr IndexType NUM_FEATURES = MIG_NODE_NUMBER + 1;
+
+        explicit MigBatchCollator(IndexType numThreads) : _numThreads(numThreads) {}
+        /// @brief collate the graphs
+        /// @param the interfaces. The node view of each is read as of its last updateGraph
+        /// @param whether to call updateGraph on every interface first
+        /// @return (edge_index [2, E], node_features [N, NUM_FEATURES], graph_id [N], num_nodes [G])
+        py::tuple collate(const std::vector<MtlInterface *> &mtls, bool updateGraph);
+
+    private:
+        /// Whether the fanins of a node of this type are edges of the graph
+        static bool hasFaninEdges(IntType nodeType)
+        {
+            return nodeType == MIG_NODE_PO || (nodeType >= MIG_NODE_NONONO && nodeType <= MIG_NODE_INVINVINV);
+        }
+        /// Grow a buffer of rows x capacity, by at least half of its size
+        template<typename T>
+        static void reserve(py::array_t<T> &buffer, std::size_t &capacity, std::size_t rows, std::size_t cols, std::size_t size)
+        {
+            if (size <= capacity && buffer.size() > 0)
+            {
+                return;
+            }
+            capacity = std::max<std::size_t>(size, capacity + capacity / 2);
+            capacity = std::max<std::size_t>(capacity, 1);
+            if (cols > 0) { buffer = py::array_t<T>({capacity, cols}); }
+            else if (rows > 0) { buffer = py::array_t<T>({rows, capacity}); }
+            else { buffer = py::array_t<T>(std::vector<std::size_t>{capacity}); }
+        }
+
+    private:
+        IndexType                 _numThreads = 0;     ///< 0 uses the OpenMP default
+        py::array_t<std::int64_t> _edgeIndex;          ///< 2 x _edgeCapacity
+        std::size_t               _edgeCapacity = 0;
+        py::array_t<float>        _features;           ///< _nodeCapacity x NUM_FEATURES
+        py::array_t<std::int64_t> _graphId;            ///< _nodeCapacity
+        std::size_t               _nodeCapacity = 0;
+        std::size_t               _graphIdCapacity = 0;
+        py::array_t<std::int64_t> _numNodes;           ///< _graphCapacity
+        std::size_t               _graphCapacity = 0;
+};
+
+py::tuple MigBatchCollator::collate(const std::vector<MtlInterface *> &mtls, bool updateGraph)
+{
+    MTL_TRACE_SPAN(OP, "collate");
+    const std::int64_t numGraphs = static_cast<std::int64_t>(mtls.size());
+    const int numThreads = _numThreads > 0 ? static_cast<int>(_numThreads) : omp_get_max_threads();
+    std::vector<std::size_t> nodeOffset(numGraphs + 1, 0), edgeOffset(numGraphs + 1, 0);
+    {
+        py::gil_scoped_release release;
+        // An interface may be listed more than once, refresh each once
+        std::vector<MtlInterface *> unique(mtls.begin(), mtls.end());
+        std::sort(unique.begin(), unique.end());
+        unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+        const std::int64_t numUnique = static_cast<std::int64_t>(unique.size());
+        #pragma omp parallel for num_threads(numThreads) schedule(dynamic, 1)
+        for (std::int64_t g = 0; g < numUnique; ++g)
+        {
+            if (updateGraph)
+            {
+                unique[g]->updateGraph();
+            }
+            else
+            {
+                // The compact view follows the live network, its PO mask must match it
+                unique[g]->syncCompactView();
+            }
+        }
+        // Count the nodes and edges of every graph
+        #pragma omp parallel for num_threads(numThreads) schedule(dynamic, 1)
+        for (std::int64_t g = 0; g < numGraphs; ++g)
+        {
+            MtlInterface &mtl = *mtls[g];
+            const IndexType numNodes = mtl.numViewNodes();
+            std::size_t numEdges = 0;
+            for (IndexType i = 0; i < numNodes; ++i)
+            {
+                MigNode node = mtl.migNode(i);
+                if (hasFaninEdges(node.nodeType()))
+                {
+                    numEdges += node.hasFanin0() + node.hasFanin1() + node.hasFanin2();
+                }
+            }
+            nodeOffset[g + 1] = numNodes;
+            edgeOffset[g + 1] = numEdges;
+        }
+    }
+    for (std::int64_t g = 0; g < numGraphs; ++g)
+    {
+        nodeOffset[g + 1] += nodeOffset[g];
+        edgeOffset[g + 1] += edgeOffset[g];
+    }
+    const std::size_t totalNodes = nodeOffset[numGraphs];
+    const std::size_t totalEdges = edgeOffset[numGraphs];
+
+    reserve(_edgeIndex, _edgeCapacity, 2, 0, totalEdges);
+    reserve(_features, _nodeCapacity, 0, NUM_FEATURES, totalNodes);
+    reserve(_graphId, _graphIdCapacity, 0, 0, totalNodes);
+    reserve(_numNodes, _graphCapacity, 0, 0, numGraphs);
+    std::int64_t *src = _edgeIndex.mutable_data();
+    std::int64_t *dst = src + _edgeCapacity;
+    float *features = _features.mutable_data();
+    std::int64_t *graphId = _graphId.mutable_data();
+    std::int64_t *numNodes = _numNodes.mutable_data();
+    {
+        py::gil_scoped_release release;
+        #pragma omp parallel for num_threads(numThreads) schedule(dynamic, 1)
+        for (std::int64_t g = 0; g < numGraphs; ++g)
+        {
+            MTL_TRACE_SPAN(ALL, "collate::graph");
+            MtlInterface &mtl = *mtls[g];
+            const std::int64_t base = static_cast<std::int64_t>(nodeOffset[g]);
+            const IndexType count = static_cast<IndexType>(nodeOffset[g + 1] - nodeOffset[g]);
+            std::size_t e = edgeOffset[g];
+            numNodes[g] = count;
+            std::fill(features + base * NUM_FEATURES, features + (base + count) * NUM_FEATURES, 0.0f);
+            std::fill(graphId + base, graphId + base + count, g);
+            for (IndexType i = 0; i < count; ++i)
+            {
+                MigNode node = mtl.migNode(i);
+                const IntType type = node.nodeType();
+                float *row = features + (base + i) * NUM_FEATURES;
+                if (type >= 0 && type < MIG_NODE_NUMBER) { row[type] = 1.0f; }
+                row[MIG_NODE_NUMBER] = static_cast<float>(node.numFanouts());
+                if (!hasFaninEdges(type))
+                {
+                    continue;
+                }
+                const std::int64_t target = base + i;
+                if (node.hasFanin0()) { src[e] = base + node.fanin0(); dst[e++] = target; }
+                if (node.hasFanin1()) { src[e] = base + node.fanin1(); dst[e++] = target; }
+                if (node.hasFanin2()) { src[e] = base + node.fanin2(); dst[e++] = target; }
+            }
+        }
+    }
+
+    // Views of the used part of the buffers
+    py::array_t<std::int64_t> edgeIndex({static_cast<std::size_t>(2), totalEdges},
+            {_edgeCapacity * sizeof(std::int64_t), sizeof(std::int64_t)}, _edgeIndex.data(), _edgeIndex);
+    py::array_t<float> nodeFeatures({totalNodes, static_cast<std::size_t>(NUM_FEATURES)},
+            {NUM_FEATURES * sizeof(float), sizeof(float)}, _features.data(), _features);
+    py::array_t<std::int64_t> graphIds(std::vector<std::size_t>{totalNodes}, std::vector<std::size_t>{sizeof(std::int64_t)},
+            _graphId.data(), _graphId);
+    py::array_t<std::int64_t> nodeCounts(std::vector<std::size_t>{static_cast<std::size_t>(numGraphs)}, std::vector<std::size_t>{sizeof(std::int64_t)},
+            _numNodes.data(), _numNodes);
+    return py::make_tuple(edgeIndex, nodeFeatures, graphIds, nodeCounts);
+}
+
+PROJECT_NAMESPACE_END
+
 void initMtlInterfaceAPI(py::module &m)
 {
+    // Registered first: used as a default argument below
+    py::enum_<PROJECT_NAMESPACE::SearchMode>(m, "SearchMode")
+        .value("BEAM", PROJECT_NAMESPACE::SearchMode::BEAM)
+        .value("MCTS", PROJECT_NAMESPACE::SearchMode::MCTS);
+
     py::class_<PROJECT_NAMESPACE::MtlInterface>(m , "MtlInterface")
         .def(py::init<>())
         .def("start", &PROJECT_NAMESPACE::MtlInterface::start, "Start the interface")
@@ -460,8 +1429,21 @@ void initMtlInterfaceAPI(py::module &m)
         .def("read_aig", &PROJECT_NAMESPACE::MtlInterface::read_aig, "Read an AIG file")
         .def("read_verilog", &PROJECT_NAMESPACE::MtlInterface::read_verilog, "Read a verilog file")
         .def("write_verilog", &PROJECT_NAMESPACE::MtlInterface::write_verilog, "Write a verilog file")
+        .def("export_shm", &PROJECT_NAMESPACE::MtlInterface::export_shm, "Export the MIG into a POSIX shared-memory segment",
+                py::arg("name"))
+        .def("import_shm", &PROJECT_NAMESPACE::MtlInterface::import_shm, "Replace the MIG by one exported into shared memory",
+                py::arg("name"))
+        .def_static("unlink_shm", &PROJECT_NAMESPACE::SharedMemory::unlink, "Remove a shared-memory segment. Existing mappings stay valid",
+                py::arg("name"))
+        .def("read_aig_mmap", &PROJECT_NAMESPACE::MtlInterface::read_aig_mmap, "Read a binary AIG file through mmap with parallel decoding",
+                py::arg("filename"), py::arg("num_threads") = 0u)
+        .def("read_verilog_mmap", &PROJECT_NAMESPACE::MtlInterface::read_verilog_mmap, "Read a verilog file through mmap")
+        .def("loadStats", &PROJECT_NAMESPACE::MtlInterface::loadStats, "Get the stats of the last mmap read")
         .def("migStats", &PROJECT_NAMESPACE::MtlInterface::migStats, "Get the MIG stats from the Mockturtle framework")
         .def("migNode", &PROJECT_NAMESPACE::MtlInterface::migNode, "Get one MigNode")
+        .def("setCompactMode", &PROJECT_NAMESPACE::MtlInterface::setCompactMode, "Derive the MigNodes lazily instead of keeping a mirror")
+        .def("compactMode", &PROJECT_NAMESPACE::MtlInterface::compactMode, "Whether the compact mode is on")
+        .def("memoryStats", &PROJECT_NAMESPACE::MtlInterface::memoryStats, "Get the memory used by each structure")
         .def("numNodes", &PROJECT_NAMESPACE::MtlInterface::numNodes, "Get the number of nodes")
         .def("balance", &PROJECT_NAMESPACE::MtlInterface::balance, "balance action",
                 py::arg("crit") = false, py::arg("cut_size") = 4u)
@@ -472,7 +1454,35 @@ void initMtlInterfaceAPI(py::module &m)
                 py::arg("max_pis") = 8u, py::arg("max_inserts") = 2u, py::arg("use_dont_cares") = false,
                 py::arg("window_size") = 12u, py::arg("preserve_depth") = false)
         .def("refactor", &PROJECT_NAMESPACE::MtlInterface::refactor, "refactor action",
-                py::arg("allow_zero_gain") = false, py::arg("use_dont_cares") = false);
+                py::arg("allow_zero_gain") = false, py::arg("use_dont_cares") = false)
+        .def("fraig", &PROJECT_NAMESPACE::MtlInterface::fraig, "fraig action: merge functionally equivalent nodes",
+                py::arg("time_limit") = 0.0, py::arg("conflict_limit") = 100u, py::arg("max_rounds") = 10u,
+                py::arg("max_tfi_nodes") = 1000u, py::arg("skip_fanout_limit") = 100u)
+        .def("map_qor", &PROJECT_NAMESPACE::MtlInterface::map_qor, "k-LUT mapping QoR, reusing the cuts of the last call",
+                py::arg("k") = 6u, py::arg("exact") = false)
+        .def("clear_qor_cache", &PROJECT_NAMESPACE::MtlInterface::clear_qor_cache, "Drop the cuts cached by map_qor")
+        .def("search", [](const PROJECT_NAMESPACE::MtlInterface &mtl, const std::vector<PROJECT_NAMESPACE::SearchAction> &actions,
+                    PROJECT_NAMESPACE::SearchMode mode, PROJECT_NAMESPACE::IndexType beam_width, PROJECT_NAMESPACE::IndexType max_length,
+                    PROJECT_NAMESPACE::IndexType max_expansions, PROJECT_NAMESPACE::RealType time_limit, PROJECT_NAMESPACE::IndexType num_threads,
+                    PROJECT_NAMESPACE::RealType node_weight, PROJECT_NAMESPACE::RealType depth_weight, PROJECT_NAMESPACE::RealType exploration)
+                {
+                    PROJECT_NAMESPACE::SearchParams params;
+                    params.mode = mode;
+                    params.beamWidth = beam_width;
+                    params.maxLength = max_length;
+                    params.maxExpansions = max_expansions;
+                    params.timeLimit = time_limit;
+                    params.numThreads = num_threads;
+                    params.nodeWeight = node_weight;
+                    params.depthWeight = depth_weight;
+                    params.exploration = exploration;
+                    py::gil_scoped_release release;
+                    return mtl.search(actions, params);
+                }, "Search a synthesis recipe from the current design",
+                py::arg("actions"), py::arg("mode") = PROJECT_NAMESPACE::SearchMode::BEAM, py::arg("beam_width") = 8u,
+                py::arg("max_length") = 10u, py::arg("max_expansions") = 1000u, py::arg("time_limit") = 0.0,
+                py::arg("num_threads") = 0u, py::arg("node_weight") = 1.0, py::arg("depth_weight") = 0.0,
+                py::arg("exploration") = 0.1);
 
     py::class_<PROJECT_NAMESPACE::MigStats>(m , "MigStats")
         .def(py::init<>())
@@ -482,6 +1492,128 @@ void initMtlInterfaceAPI(py::module &m)
         .def_property("numMigNodes", &PROJECT_NAMESPACE::MigStats::numMigNodes, &PROJECT_NAMESPACE::MigStats::setNumMigNodes)
         .def_property("lev", &PROJECT_NAMESPACE::MigStats::lev, &PROJECT_NAMESPACE::MigStats::setLev);
 
+    py::class_<PROJECT_NAMESPACE::SearchAction>(m, "SearchAction")
+        .def_static("balance", &PROJECT_NAMESPACE::SearchAction::balance, "balance action",
+                py::arg("crit") = false, py::arg("cut_size") = 4u)
+        .def_static("rewrite", &PROJECT_NAMESPACE::SearchAction::rewrite, "rewrite action",
+                py::arg("allow_zero_gain") = false, py::arg("use_dont_cares") = false,
+                py::arg("preserve_depth") = false, py::arg("min_cut_size") = 3u)
+        .def_static("refactor", &PROJECT_NAMESPACE::SearchAction::refactor, "refactor action",
+                py::arg("allow_zero_gain") = false, py::arg("use_dont_cares") = false)
+        .def_static("resub", &PROJECT_NAMESPACE::SearchAction::resub, "resub action",
+                py::arg("max_pis") = 8u, py::arg("max_inserts") = 2u, py::arg("use_dont_cares") = false,
+                py::arg("window_size") = 12u, py::arg("preserve_depth") = false)
+        .def("__repr__", &PROJECT_NAMESPACE::SearchAction::str);
+
+    py::class_<PROJECT_NAMESPACE::SearchPoint>(m, "SearchPoint")
+        .def_property_readonly("numGates", &PROJECT_NAMESPACE::SearchPoint::numGates)
+        .def_property_readonly("depth", &PROJECT_NAMESPACE::SearchPoint::depth)
+        .def_property_readonly("cost", &PROJECT_NAMESPACE::SearchPoint::cost)
+        .def_property_readonly("recipe", [](const PROJECT_NAMESPACE::SearchPoint &point)
+                {
+                    // Indices into the action set
+                    py::list recipe;
+                    for (auto a : point.recipe()) { recipe.append(a); }
+                    return recipe;
+                });
+
+    py::class_<PROJECT_NAMESPACE::SearchResult>(m, "SearchResult")
+        .def_property_readonly("best", &PROJECT_NAMESPACE::SearchResult::best)
+        .def_property_readonly("paretoFront", py::overload_cast<>(&PROJECT_NAMESPACE::SearchResult::paretoFront, py::const_))
+        .def_property_readonly("numExpansions", &PROJECT_NAMESPACE::SearchResult::numExpansions)
+        .def_property_readonly("numUniqueStates", &PROJECT_NAMESPACE::SearchResult::numUniqueStates)
+        .def_property_readonly("time", &PROJECT_NAMESPACE::SearchResult::time);
+
+    py::class_<PROJECT_NAMESPACE::MigBatchCollator>(m, "MigBatchCollator")
+        .def(py::init<PROJECT_NAMESPACE::IndexType>(), py::arg("num_threads") = 0u)
+        .def("collate", &PROJECT_NAMESPACE::MigBatchCollator::collate,
+                "Collate interfaces into one batch: (edge_index, node_features, graph_id, num_nodes). The arrays are reused by the next call",
+                py::arg("interfaces"), py::arg("update_graph") = false)
+        .def_property_readonly_static("numFeatures", [](py::object) { return PROJECT_NAMESPACE::MigBatchCollator::NUM_FEATURES; });
+
+    // The arrays are read-only views of the mapping. Each one owns a reference to it,
+    // so close() and attach() on the view never unmap memory an array still uses
+    auto shmBase = [](const PROJECT_NAMESPACE::MigShmView &view)
+    {
+        auto *owner = new std::shared_ptr<const PROJECT_NAMESPACE::SharedMemory>(view.mapping());
+        return py::capsule(owner, [](void *p) { delete static_cast<std::shared_ptr<const PROJECT_NAMESPACE::SharedMemory> *>(p); });
+    };
+    auto shmArray = [shmBase](const PROJECT_NAMESPACE::MigShmView &view, const std::uint32_t *data, std::vector<std::size_t> shape)
+    {
+        std::vector<std::size_t> strides(shape.size(), sizeof(std::uint32_t));
+        if (shape.size() == 2) { strides[0] = shape[1] * sizeof(std::uint32_t); }
+        py::array_t<std::uint32_t> array(shape, strides, data, shmBase(view));
+        array.attr("setflags")(py::arg("write") = false);
+        return array;
+    };
+    py::class_<PROJECT_NAMESPACE::MigShmView>(m, "MigShmView")
+        .def(py::init<>())
+        .def("attach", &PROJECT_NAMESPACE::MigShmView::attach, "Map a MIG exported into shared memory", py::arg("name"))
+        .def("close", &PROJECT_NAMESPACE::MigShmView::close, "Drop the mapping of this view. The arrays keep their own reference to it")
+        .def("isOpen", &PROJECT_NAMESPACE::MigShmView::isOpen)
+        .def("numNodes", &PROJECT_NAMESPACE::MigShmView::numNodes)
+        .def("numPis", &PROJECT_NAMESPACE::MigShmView::numPis)
+        .def("numPos", &PROJECT_NAMESPACE::MigShmView::numPos)
+        .def("depth", &PROJECT_NAMESPACE::MigShmView::depth)
+        .def("migNode", &PROJECT_NAMESPACE::MigShmView::migNode, "Get one MigNode")
+        .def_property_readonly("literals", [shmArray](const PROJECT_NAMESPACE::MigShmView &view)
+                {
+                    return shmArray(view, view.literals(), {view.numNodes(), 3});
+                }, "Fanin literals 2 * index + complement, [numNodes, 3]")
+        .def_property_readonly("fanouts", [shmArray](const PROJECT_NAMESPACE::MigShmView &view)
+                {
+                    return shmArray(view, view.fanouts(), {view.numNodes()});
+                }, "Fanout count of each node, [numNodes]")
+        .def_property_readonly("outputs", [shmArray](const PROJECT_NAMESPACE::MigShmView &view)
+                {
+                    return shmArray(view, view.outputs(), {view.numPos()});
+                }, "PO literals, [numPos]")
+        .def_property_readonly("flags", [shmBase](const PROJECT_NAMESPACE::MigShmView &view)
+                {
+                    py::array_t<PROJECT_NAMESPACE::Byte> array(std::vector<std::size_t>{view.numNodes()},
+                            std::vector<std::size_t>{sizeof(PROJECT_NAMESPACE::Byte)}, view.flags(), shmBase(view));
+                    array.attr("setflags")(py::arg("write") = false);
+                    return array;
+                }, "Bit 0: PI, bit 1: PO, [numNodes]");
+
+    py::class_<PROJECT_NAMESPACE::MemoryStats>(m, "MemoryStats")
+        .def(py::init<>())
+        .def_property_readonly("migNodes", &PROJECT_NAMESPACE::MemoryStats::migNodes)
+        .def_property_readonly("migHash", &PROJECT_NAMESPACE::MemoryStats::migHash)
+        .def_property_readonly("migIo", &PROJECT_NAMESPACE::MemoryStats::migIo)
+        .def_property_readonly("nodeView", &PROJECT_NAMESPACE::MemoryStats::nodeView)
+        .def_property_readonly("lutCache", &PROJECT_NAMESPACE::MemoryStats::lutCache)
+        .def_property_readonly("total", &PROJECT_NAMESPACE::MemoryStats::total);
+
+    py::class_<PROJECT_NAMESPACE::FraigStats>(m, "FraigStats")
+        .def(py::init<>())
+        .def_property_readonly("numMerges", &PROJECT_NAMESPACE::FraigStats::numMerges)
+        .def_property_readonly("numConstMerges", &PROJECT_NAMESPACE::FraigStats::numConstMerges)
+        .def_property_readonly("numEquivMerges", &PROJECT_NAMESPACE::FraigStats::numEquivMerges)
+        .def_property_readonly("numRounds", &PROJECT_NAMESPACE::FraigStats::numRounds)
+        .def_property_readonly("gatesBefore", &PROJECT_NAMESPACE::FraigStats::gatesBefore)
+        .def_property_readonly("gatesAfter", &PROJECT_NAMESPACE::FraigStats::gatesAfter)
+        .def_property_readonly("outOfTime", &PROJECT_NAMESPACE::FraigStats::outOfTime)
+        .def_property_readonly("simTime", &PROJECT_NAMESPACE::FraigStats::simTime)
+        .def_property_readonly("satTime", &PROJECT_NAMESPACE::FraigStats::satTime)
+        .def_property_readonly("totalTime", &PROJECT_NAMESPACE::FraigStats::totalTime);
+
+    py::class_<PROJECT_NAMESPACE::MapQor>(m, "MapQor")
+        .def(py::init<>())
+        .def_property_readonly("lutCount", &PROJECT_NAMESPACE::MapQor::lutCount)
+        .def_property_readonly("lutDepth", &PROJECT_NAMESPACE::MapQor::lutDepth)
+        .def_property_readonly("numReused", &PROJECT_NAMESPACE::MapQor::numReused)
+        .def_property_readonly("numComputed", &PROJECT_NAMESPACE::MapQor::numComputed)
+        .def_property_readonly("time", &PROJECT_NAMESPACE::MapQor::time);
+
+    py::class_<PROJECT_NAMESPACE::LoadStats>(m , "LoadStats")
+        .def(py::init<>())
+        .def_property_readonly("numBytes", &PROJECT_NAMESPACE::LoadStats::numBytes)
+        .def_property_readonly("parseTime", &PROJECT_NAMESPACE::LoadStats::parseTime)
+        .def_property_readonly("buildTime", &PROJECT_NAMESPACE::LoadStats::buildTime)
+        .def_property_readonly("totalTime", &PROJECT_NAMESPACE::LoadStats::totalTime)
+        .def_property_readonly("mbPerSec", &PROJECT_NAMESPACE::LoadStats::mbPerSec);
+
     py::class_<PROJECT_NAMESPACE::MigNode>(m, "MigNode")
         .def(py::init<>())
         .def("hasFanin0", &PROJECT_NAMESPACE::MigNode::hasFanin0, "Whether the node has fanin0")
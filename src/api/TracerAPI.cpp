@@ -0,0 +1,22 @@
+#include <pybind11/pybind11.h>
+#include "global/global.h"
+
+namespace py = pybind11;
+void initTracerAPI(py::module &m)
+{
+    py::enum_<PROJECT_NAMESPACE::TraceLevel>(m, "TraceLevel")
+        .value("OFF", PROJECT_NAMESPACE::TraceLevel::OFF)
+        .value("OP", PROJECT_NAMESPACE::TraceLevel::OP)
+        .value("DETAIL", PROJECT_NAMESPACE::TraceLevel::DETAIL)
+        .value("ALL", PROJECT_NAMESPACE::TraceLevel::ALL);
+
+    m.def("setTraceLevel", &PROJECT_NAMESPACE::Tracer::setLevel, "Set the runtime trace level", py::arg("level"));
+    m.def("traceLevel", &PROJECT_NAMESPACE::Tracer::level, "Get the runtime trace level");
+    m.def("setTraceBufferCapacity", &PROJECT_NAMESPACE::Tracer::setBufferCapacity,
+            "Set the number of events kept per thread", py::arg("capacity"));
+    m.def("dumpTrace", &PROJECT_NAMESPACE::Tracer::dumpChromeTrace,
+            "Write the recorded spans as Chrome trace-event JSON", py::arg("filename"));
+    m.def("clearTrace", &PROJECT_NAMESPACE::Tracer::clear, "Drop the recorded spans");
+    m.def("screenOn", &PROJECT_NAMESPACE::MsgPrinter::screenOn, "Print the messages to stderr");
+    m.def("screenOff", &PROJECT_NAMESPACE::MsgPrinter::screenOff, "Stop printing the messages to stderr");
+}
@@ -5,10 +5,12 @@
 namespace py = pybind11;
 
 void initMtlInterfaceAPI(py::module &);
+void initTracerAPI(py::module &);
 
 PYBIND11_MAKE_OPAQUE(std::vector<PROJECT_NAMESPACE::IndexType>);
 
 PYBIND11_MODULE(mtlPy, m)
 {
     initMtlInterfaceAPI(m);
+    initTracerAPI(m);
 }
@@ -8,6 +8,7 @@
 #include "parameter.h"
 #include "util/MsgPrinter.h"
 #include "util/Assert.h"
+#include "util/Tracer.h"
 
 PROJECT_NAMESPACE_BEGIN
 
@@ -0,0 +1,223 @@
+#include "AigerParser.h"
+#include <omp.h>
+#include <cstring>
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// Parse an unsigned decimal at pos, skipping leading blanks
+    bool parseUnsigned(const char *data, std::size_t size, std::size_t &pos, IndexType &value)
+    {
+        while (pos < size && data[pos] == ' ') { ++pos; }
+        if (pos >= size || data[pos] < '0' || data[pos] > '9')
+        {
+            return false;
+        }
+        std::uint64_t v = 0;
+        while (pos < size && data[pos] >= '0' && data[pos] <= '9')
+        {
+            v = v * 10 + static_cast<std::uint64_t>(data[pos] - '0');
+            if (v > INDEX_TYPE_MAX) { return false; }
+            ++pos;
+        }
+        value = static_cast<IndexType>(v);
+        return true;
+    }
+
+    /// Move pos past the end of the current line
+    bool skipLine(const char *data, std::size_t size, std::size_t &pos)
+    {
+        const void *nl = std::memchr(data + pos, '\n', size - pos);
+        if (nl == nullptr)
+        {
+            return false;
+        }
+        pos = static_cast<const char *>(nl) - data + 1;
+        return true;
+    }
+}
+
+bool AigerParser::parse(const char *data, std::size_t size, AigerData &aig) const
+{
+    MTL_TRACE_SPAN(DETAIL, "AigerParser::parse");
+    if (size < 4 || std::strncmp(data, "aig ", 4) != 0)
+    {
+        ERR("Not a binary AIGER file\n");
+        return false;
+    }
+    std::size_t pos = 4;
+    IndexType maxVar, numInputs, numLatches, numOutputs, numAnds;
+    if (!parseUnsigned(data, size, pos, maxVar) || !parseUnsigned(data, size, pos, numInputs)
+            || !parseUnsigned(data, size, pos, numLatches) || !parseUnsigned(data, size, pos, numOutputs)
+            || !parseUnsigned(data, size, pos, numAnds))
+    {
+        ERR("Invalid AIGER header\n");
+        return false;
+    }
+    // AIGER 1.9 extensions B C J F. Only empty ones are combinational
+    IndexType extra;
+    while (parseUnsigned(data, size, pos, extra))
+    {
+        if (extra != 0)
+        {
+            ERR("AIGER bad/constraint/justice/fairness properties are not supported\n");
+            return false;
+        }
+    }
+    if (numLatches != 0)
+    {
+        ERR("Sequential AIGER is not supported: %u latches\n", numLatches);
+        return false;
+    }
+    if (static_cast<std::uint64_t>(numInputs) + numAnds != maxVar)
+    {
+        ERR("Invalid AIGER header: M %u != I %u + A %u\n", maxVar, numInputs, numAnds);
+        return false;
+    }
+    if (!skipLine(data, size, pos))
+    {
+        ERR("Truncated AIGER header\n");
+        return false;
+    }
+
+    aig._numInputs = numInputs;
+    aig._numAnds = numAnds;
+    aig._outputs.resize(numOutputs);
+    for (IndexType i = 0; i < numOutputs; ++i)
+    {
+        if (!parseUnsigned(data, size, pos, aig._outputs[i]) || !skipLine(data, size, pos))
+        {
+            ERR("Truncated AIGER output section at output %u\n", i);
+            return false;
+        }
+        if (aig._outputs[i] > 2 * maxVar + 1)
+        {
+            ERR("AIGER output %u refers to literal %u beyond M\n", i, aig._outputs[i]);
+            return false;
+        }
+    }
+    const Byte *begin = reinterpret_cast<const Byte *>(data) + pos;
+    const Byte *end = reinterpret_cast<const Byte *>(data) + size;
+    return decodeAnds(begin, end, aig);
+}
+
+/// Decode the binary AND section. [begin, end) also covers the trailing
+/// symbol table and comments: they are ASCII, so they only add terminators
+/// after the 2A varints we need and are never decoded.
+bool AigerParser::decodeAnds(const Byte *begin, const Byte *end, AigerData &aig) const
+{
+    MTL_TRACE_SPAN(DETAIL, "AigerParser::decodeAnds");
+    const std::uint64_t numVarints = 2 * static_cast<std::uint64_t>(aig._numAnds);
+    aig._andFanins.resize(numVarints);
+    if (numVarints == 0)
+    {
+        return true;
+    }
+    const std::size_t size = end - begin;
+    const IndexType numThreads = _numThreads > 0 ? _numThreads : static_cast<IndexType>(omp_get_max_threads());
+    // Small chunks keep the threads balanced. Big enough to amortize the prefix sum
+    const std::size_t minChunk = 1 << 20;
+    std::size_t numChunks = std::max<std::size_t>(1, std::min<std::size_t>(4 * numThreads, size / minChunk));
+    std::vector<std::size_t> bounds(numChunks + 1);
+    for (std::size_t c = 0; c <= numChunks; ++c)
+    {
+        bounds[c] = size * c / numChunks;
+    }
+
+    // Pass 1: a chunk owns the varints whose terminating byte (MSB clear) lies in it
+    std::vector<std::uint64_t> firstVarint(numChunks + 1, 0);
+    #pragma omp parallel for num_threads(numThreads) schedule(dynamic, 1)
+    for (std::size_t c = 0; c < numChunks; ++c)
+    {
+        MTL_TRACE_SPAN(ALL, "AigerParser::count");
+        std::uint64_t count = 0;
+        for (std::size_t i = bounds[c]; i < bounds[c + 1]; ++i)
+        {
+            count += (begin[i] >> 7) ^ 1;
+        }
+        firstVarint[c + 1] = count;
+    }
+    for (std::size_t c = 0; c < numChunks; ++c)
+    {
+        firstVarint[c + 1] += firstVarint[c];
+    }
+    if (firstVarint[numChunks] < numVarints)
+    {
+        ERR("Truncated AIGER AND section: %lu / %lu deltas\n", firstVarint[numChunks], numVarints);
+        return false;
+    }
+
+    // Pass 2: decode the deltas of every chunk independently
+    std::vector<IndexType> &deltas = aig._andFanins;
+    bool overflow = false;
+    #pragma omp parallel for num_threads(numThreads) schedule(dynamic, 1) reduction(||: overflow)
+    for (std::size_t c = 0; c < numChunks; ++c)
+    {
+        MTL_TRACE_SPAN(ALL, "AigerParser::decode");
+        std::uint64_t idx = firstVarint[c];
+        if (idx >= numVarints)
+        {
+            continue;
+        }
+        // Rewind to the start of the varint whose terminator is the first one in this chunk
+        std::size_t pos = bounds[c];
+        while (pos > 0 && (begin[pos - 1] & 0x80)) { --pos; }
+        const std::size_t chunkEnd = bounds[c + 1];
+        while (idx < numVarints && pos < chunkEnd)
+        {
+            std::uint64_t value = 0;
+            IndexType shift = 0;
+            Byte ch;
+            do
+            {
+                ch = begin[pos++];
+                value |= static_cast<std::uint64_t>(ch & 0x7f) << shift;
+                shift += 7;
+            } while ((ch & 0x80) && pos < size && shift < 64);
+            if (pos - 1 >= chunkEnd)
+            {
+                // Terminated in the next chunk, which owns it
+                break;
+            }
+            if (value > INDEX_TYPE_MAX)
+            {
+                overflow = true;
+                break;
+            }
+            deltas[idx++] = static_cast<IndexType>(value);
+        }
+    }
+    if (overflow)
+    {
+        ERR("Invalid delta in the AIGER AND section\n");
+        return false;
+    }
+
+    // Pass 3: turn the deltas into fanin literals. Gate i has lhs = 2 * (I + 1 + i)
+    const std::int64_t numAnds = aig._numAnds;
+    const std::uint64_t lhsBase = 2 * (static_cast<std::uint64_t>(aig._numInputs) + 1);
+    bool invalid = false;
+    #pragma omp parallel for num_threads(numThreads) schedule(static) reduction(||: invalid)
+    for (std::int64_t i = 0; i < numAnds; ++i)
+    {
+        const std::uint64_t lhs = lhsBase + 2 * static_cast<std::uint64_t>(i);
+        const std::uint64_t d0 = deltas[2 * i];
+        const std::uint64_t d1 = deltas[2 * i + 1];
+        if (d0 == 0 || d0 > lhs || d1 > lhs - d0)
+        {
+            invalid = true;
+            continue;
+        }
+        deltas[2 * i] = static_cast<IndexType>(lhs - d0);
+        deltas[2 * i + 1] = static_cast<IndexType>(lhs - d0 - d1);
+    }
+    if (invalid)
+    {
+        ERR("Invalid delta in the AIGER AND section\n");
+        return false;
+    }
+    return true;
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,59 @@
+#ifndef MTL_PY_AIGER_PARSER_H_
+#define MTL_PY_AIGER_PARSER_H_
+
+#include <vector>
+#include "global/global.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MTL_PY::AigerData
+/// @brief The combinational content of a binary AIGER file, as AIGER literals
+class AigerData
+{
+    public:
+        explicit AigerData() = default;
+        IndexType numInputs() const { return _numInputs; }
+        IndexType numOutputs() const { return static_cast<IndexType>(_outputs.size()); }
+        IndexType numAnds() const { return _numAnds; }
+        /// @brief the literal driving output i
+        IndexType output(IndexType i) const { return _outputs[i]; }
+        /// @brief the first fanin literal of AND gate i. Its own variable is numInputs + 1 + i
+        IndexType and0(IndexType i) const { return _andFanins[2 * i]; }
+        /// @brief the second fanin literal of AND gate i
+        IndexType and1(IndexType i) const { return _andFanins[2 * i + 1]; }
+
+    private:
+        friend class AigerParser;
+        IndexType              _numInputs = 0;  ///< I of the header
+        IndexType              _numAnds = 0;    ///< A of the header
+        std::vector<IndexType> _outputs;        ///< The output literals
+        std::vector<IndexType> _andFanins;      ///< Two fanin literals per AND gate
+};
+
+/// @class MTL_PY::AigerParser
+/// @brief Parser of binary AIGER ("aig") held in memory
+/// The delta-encoded AND section is decoded in parallel chunks: each chunk
+/// counts the varint terminators it owns, a prefix sum gives the index of its
+/// first varint, then all the chunks decode independently.
+class AigerParser
+{
+    public:
+        explicit AigerParser() = default;
+        /// @brief set the number of decoding threads. 0 uses the OpenMP default
+        void setNumThreads(IndexType numThreads) { _numThreads = numThreads; }
+        /// @brief parse a binary AIGER buffer
+        /// @param the buffer and its size
+        /// @param the parsed content
+        /// @return whether the buffer is a valid combinational binary AIGER
+        bool parse(const char *data, std::size_t size, AigerData &aig) const;
+
+    private:
+        bool decodeAnds(const Byte *begin, const Byte *end, AigerData &aig) const;
+
+    private:
+        IndexType _numThreads = 0; ///< Number of decoding threads
+};
+
+PROJECT_NAMESPACE_END
+
+#endif // MTL_PY_AIGER_PARSER_H_
@@ -0,0 +1,646 @@
+#ifndef MTL_PY_RECIPE_SEARCH_H_
+#define MTL_PY_RECIPE_SEARCH_H_
+
+#include <omp.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+#include "global/global.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// ================================================================================
+/// Native synthesis-recipe search
+/// A recipe is a sequence of actions (balance/rewrite/refactor/resub with fixed
+/// parameters). The search explores recipes from a snapshot of the current
+/// design, minimizing a weighted sum of the gate count and the depth, both
+/// relative to the starting design.
+///
+/// States are keyed by their structural hash: a structure reached by several
+/// recipes is evaluated and expanded only once.
+/// ================================================================================
+
+/// Enum type for the synthesis operations
+enum class SearchOp
+{
+    BALANCE,
+    REWRITE,
+    REFACTOR,
+    RESUB
+};
+
+/// Enum type for the search strategies
+enum class SearchMode
+{
+    BEAM, ///< Breadth-first, keep the best beamWidth states of every recipe length
+    MCTS  ///< Monte-Carlo tree search with UCT selection, no random rollouts
+};
+
+/// @class MTL_PY::SearchAction
+/// @brief One synthesis operation with its parameters
+class SearchAction
+{
+    public:
+        explicit SearchAction() = default;
+        static SearchAction balance(bool crit, IndexType cutSize)
+        {
+            SearchAction action;
+            action._op = SearchOp::BALANCE;
+            action._crit = crit;
+            action._cutSize = cutSize;
+            return action;
+        }
+        static SearchAction rewrite(bool allowZeroGain, bool useDontCares, bool preserveDepth, IndexType minCutSize)
+        {
+            SearchAction action;
+            action._op = SearchOp::REWRITE;
+            action._allowZeroGain = allowZeroGain;
+            action._useDontCares = useDontCares;
+            action._preserveDepth = preserveDepth;
+            action._minCutSize = minCutSize;
+            return action;
+        }
+        static SearchAction refactor(bool allowZeroGain, bool useDontCares)
+        {
+            SearchAction action;
+            action._op = SearchOp::REFACTOR;
+            action._allowZeroGain = allowZeroGain;
+            action._useDontCares = useDontCares;
+            return action;
+        }
+        static SearchAction resub(IndexType maxPis, IndexType maxInserts, bool useDontCares, IndexType windowSize, bool preserveDepth)
+        {
+            SearchAction action;
+            action._op = SearchOp::RESUB;
+            action._maxPis = maxPis;
+            action._maxInserts = maxInserts;
+            action._useDontCares = useDontCares;
+            action._windowSize = windowSize;
+            action._preserveDepth = preserveDepth;
+            return action;
+        }
+
+        SearchOp op() const { return _op; }
+        bool crit() const { return _crit; }
+        IndexType cutSize() const { return _cutSize; }
+        bool allowZeroGain() const { return _allowZeroGain; }
+        bool useDontCares() const { return _useDontCares; }
+        bool preserveDepth() const { return _preserveDepth; }
+        IndexType minCutSize() const { return _minCutSize; }
+        IndexType maxPis() const { return _maxPis; }
+        IndexType maxInserts() const { return _maxInserts; }
+        IndexType windowSize() const { return _windowSize; }
+
+        /// @brief readable form, e.g. "rewrite(allow_zero_gain=1, ...)"
+        std::string str() const
+        {
+            std::ostringstream oss;
+            switch (_op)
+            {
+                case SearchOp::BALANCE:
+                    oss << "balance(crit=" << _crit << ", cut_size=" << _cutSize << ")"; break;
+                case SearchOp::REWRITE:
+                    oss << "rewrite(allow_zero_gain=" << _allowZeroGain << ", use_dont_cares=" << _useDontCares
+                        << ", preserve_depth=" << _preserveDepth << ", min_cut_size=" << _minCutSize << ")"; break;
+                case SearchOp::REFACTOR:
+                    oss << "refactor(allow_zero_gain=" << _allowZeroGain << ", use_dont_cares=" << _useDontCares << ")"; break;
+                case SearchOp::RESUB:
+                    oss << "resub(max_pis=" << _maxPis << ", max_inserts=" << _maxInserts << ", use_dont_cares=" << _useDontCares
+                        << ", window_size=" << _windowSize << ", preserve_depth=" << _preserveDepth << ")"; break;
+            }
+            return oss.str();
+        }
+
+    private:
+        SearchOp  _op = SearchOp::BALANCE; ///< The operation
+        bool      _crit = false;           ///< balance: only on the critical path
+        IndexType _cutSize = 4;            ///< balance: cut size
+        bool      _allowZeroGain = false;  ///< rewrite/refactor
+        bool      _useDontCares = false;   ///< rewrite/refactor/resub
+        bool      _preserveDepth = false;  ///< rewrite/resub
+        IndexType _minCutSize = 3;         ///< rewrite: minimum candidate cut size
+        IndexType _maxPis = 8;             ///< resub
+        IndexType _maxInserts = 2;         ///< resub
+        IndexType _windowSize = 12;        ///< resub
+};
+
+/// @struct MTL_PY::SearchParams
+/// @brief Budget and objective of a recipe search
+struct SearchParams
+{
+    SearchMode mode = SearchMode::BEAM;  ///< The strategy
+    IndexType  beamWidth = 8;            ///< BEAM: states kept per recipe length
+    IndexType  maxLength = 10;           ///< Maximum number of actions in a recipe
+    IndexType  maxExpansions = 1000;     ///< Budget on the number of applied actions
+    RealType   timeLimit = 0.0;          ///< Budget in wall-clock seconds. 0 for none
+    IndexType  numThreads = 0;           ///< 0 uses the OpenMP default
+    RealType   nodeWeight = 1.0;         ///< Weight of the relative gate count
+    RealType   depthWeight = 0.0;        ///< Weight of the relative depth
+    RealType   exploration = 0.1;        ///< MCTS: UCT exploration constant
+};
+
+/// @class MTL_PY::SearchPoint
+/// @brief A design reached by a recipe
+class SearchPoint
+{
+    public:
+        explicit SearchPoint() = default;
+        IndexType numGates() const { return _numGates; }
+        IndexType depth() const { return _depth; }
+        RealType cost() const { return _cost; }
+        /// @brief the recipe, as indices into the action set
+        const std::vector<IndexType> & recipe() const { return _recipe; }
+
+        void setNumGates(IndexType numGates) { _numGates = numGates; }
+        void setDepth(IndexType depth) { _depth = depth; }
+        void setCost(RealType cost) { _cost = cost; }
+        void setRecipe(const std::vector<IndexType> &recipe) { _recipe = recipe; }
+    private:
+        IndexType              _numGates = 0; ///< Number of gates
+        IndexType              _depth = 0;    ///< Logic depth
+        RealType               _cost = 0;     ///< Objective, lower is better
+        std::vector<IndexType> _recipe;       ///< Actions leading to the design
+};
+
+/// @class MTL_PY::SearchResult
+/// @brief Outcome of a recipe search
+class SearchResult
+{
+    public:
+        explicit SearchResult() = default;
+        const SearchPoint & best() const { return _best; }
+        /// @brief the non-dominated designs over (gates, depth), sorted by gate count
+        const std::vector<SearchPoint> & paretoFront() const { return _pareto; }
+        IndexType numExpansions() const { return _numExpansions; }
+        IndexType numUniqueStates() const { return _numUnique; }
+        RealType time() const { return _time; }
+
+        void setBest(const SearchPoint &best) { _best = best; }
+        std::vector<SearchPoint> & paretoFront() { return _pareto; }
+        void setNumExpansions(IndexType numExpansions) { _numExpansions = numExpansions; }
+        void setNumUniqueStates(IndexType numUnique) { _numUnique = numUnique; }
+        void setTime(RealType time) { _time = time; }
+    private:
+        SearchPoint              _best;              ///< Lowest cost design
+        std::vector<SearchPoint> _pareto;            ///< Pareto front over (gates, depth)
+        IndexType                _numExpansions = 0; ///< Number of applied actions
+        IndexType                _numUnique = 0;     ///< Number of structurally distinct states
+        RealType                 _time = 0;          ///< Wall-clock seconds
+};
+
+/// @class MTL_PY::RecipeSearch
+/// @brief The search engine over states of type State
+/// State must provide: State snapshot() const, a deep copy that only reads
+/// the state, as one parent is copied by several threads at once;
+/// void applyAction(const SearchAction &); IndexType numGates();
+/// IndexType depth(); std::uint64_t structuralHash().
+/// Snapshots are expanded concurrently, one per thread.
+template<class State>
+class RecipeSearch
+{
+    public:
+        explicit RecipeSearch(const std::vector<SearchAction> &actions, const SearchParams &params)
+            : _actions(actions), _params(params) {}
+
+        /// @brief search from a root state
+        /// @return the best recipe and the Pareto front
+        SearchResult run(const State &root);
+
+    private:
+        static constexpr IntType UNEXPANDED = -1; ///< Child slot never tried
+        static constexpr IntType PENDING = -2;    ///< Child slot being expanded
+
+        /// A distinct design of the search
+        struct SearchNode
+        {
+            State                  state;       ///< Released when no longer needed
+            bool                   hasState = false;
+            std::uint64_t          key = 0;     ///< Structural hash
+            IndexType              numGates = 0;
+            IndexType              depth = 0;
+            RealType               cost = 0;
+            std::vector<IndexType> recipe;      ///< The first recipe that reached it
+            std::vector<IntType>   children;    ///< MCTS: node per action
+            IndexType              visits = 0;  ///< MCTS
+            RealType               value = 0;   ///< MCTS: sum of rewards
+            IndexType              virtualLoss = 0;
+            bool                   exhausted = false; ///< MCTS: no action left to try below it
+        };
+
+        /// An action applied on a state, evaluated in parallel
+        struct Expansion
+        {
+            IndexType     parent = 0;
+            IndexType     action = 0;
+            State         state;
+            std::uint64_t key = 0;
+            IndexType     numGates = 0;
+            IndexType     depth = 0;
+            bool          done = false;
+            std::vector<IndexType> path; ///< MCTS: nodes from the root to parent
+        };
+
+        RealType cost(IndexType numGates, IndexType depth) const
+        {
+            return _params.nodeWeight * numGates / std::max<RealType>(_rootGates, 1)
+                 + _params.depthWeight * depth / std::max<RealType>(_rootDepth, 1);
+        }
+        bool outOfTime() const
+        {
+            return _params.timeLimit > 0 && elapsed() >= _params.timeLimit;
+        }
+        RealType elapsed() const
+        {
+            return std::chrono::duration<RealType>(std::chrono::steady_clock::now() - _beginTime).count();
+        }
+        IndexType numThreads() const
+        {
+            return _params.numThreads > 0 ? _params.numThreads : static_cast<IndexType>(omp_get_max_threads());
+        }
+
+        void evaluate(std::vector<Expansion> &jobs);
+        /// @return the node reached, and whether it is new
+        std::pair<IndexType, bool> merge(Expansion &job);
+        void updatePareto(const SearchNode &node);
+        void runBeam();
+        void runMcts();
+        IntType selectChild(const SearchNode &node) const;
+        void updateExhausted(const std::vector<IndexType> &path);
+
+    private:
+        std::vector<SearchAction>                _actions;
+        SearchParams                             _params;
+        std::deque<SearchNode>                   _nodes;      ///< All the distinct states, stable references
+        std::unordered_map<std::uint64_t, IndexType> _table;  ///< Structural hash to node
+        IndexType                                _numExpansions = 0;
+        IndexType                                _rootGates = 0;
+        IndexType                                _rootDepth = 0;
+        IndexType                                _best = 0;
+        std::vector<SearchPoint>                 _pareto;
+        std::chrono::steady_clock::time_point    _beginTime;
+};
+
+template<class State>
+SearchResult RecipeSearch<State>::run(const State &root)
+{
+    MTL_TRACE_SPAN(OP, "RecipeSearch::run");
+    _beginTime = std::chrono::steady_clock::now();
+    _nodes.clear();
+    _table.clear();
+    _pareto.clear();
+    _numExpansions = 0;
+
+    _nodes.emplace_back();
+    SearchNode &rootNode = _nodes.back();
+    rootNode.state = root.snapshot();
+    rootNode.hasState = true;
+    rootNode.key = rootNode.state.structuralHash();
+    rootNode.numGates = rootNode.state.numGates();
+    rootNode.depth = rootNode.state.depth();
+    rootNode.children.assign(_actions.size(), UNEXPANDED);
+    rootNode.exhausted = _params.maxLength == 0;
+    _rootGates = rootNode.numGates;
+    _rootDepth = rootNode.depth;
+    rootNode.cost = cost(rootNode.numGates, rootNode.depth);
+    _table[rootNode.key] = 0;
+    _best = 0;
+    updatePareto(rootNode);
+
+    if (!_actions.empty())
+    {
+        if (_params.mode == SearchMode::BEAM) { runBeam(); }
+        else { runMcts(); }
+    }
+
+    SearchResult result;
+    const SearchNode &best = _nodes[_best];
+    SearchPoint point;
+    point.setNumGates(best.numGates);
+    point.setDepth(best.depth);
+    point.setCost(best.cost);
+    point.setRecipe(best.recipe);
+    result.setBest(point);
+    result.paretoFront() = _pareto;
+    result.setNumExpansions(_numExpansions);
+    result.setNumUniqueStates(static_cast<IndexType>(_nodes.size()));
+    result.setTime(elapsed());
+    _nodes.clear(); // Release the snapshots
+    _table.clear();
+    return result;
+}
+
+/// Apply the actions of the jobs on copies of their parents, in parallel
+template<class State>
+void RecipeSearch<State>::evaluate(std::vector<Expansion> &jobs)
+{
+    MTL_TRACE_SPAN(DETAIL, "RecipeSearch::evaluate");
+    const std::int64_t numJobs = static_cast<std::int64_t>(jobs.size());
+    #pragma omp parallel for num_threads(numThreads()) schedule(dynamic, 1)
+    for (std::int64_t j = 0; j < numJobs; ++j)
+    {
+        if (outOfTime())
+        {
+            continue;
+        }
+        MTL_TRACE_SPAN(DETAIL, "RecipeSearch::expand");
+        Expansion &job = jobs[j];
+        job.state = _nodes[job.parent].state.snapshot();
+        job.state.applyAction(_actions[job.action]);
+        job.key = job.state.structuralHash();
+        job.numGates = job.state.numGates();
+        job.depth = job.state.depth();
+        job.done = true;
+    }
+    for (const Expansion &job : jobs)
+    {
+        _numExpansions += job.done ? 1 : 0;
+    }
+}
+
+/// Record an evaluated job, sharing the node of an already seen structure
+template<class State>
+std::pair<IndexType, bool> RecipeSearch<State>::merge(Expansion &job)
+{
+    auto it = _table.find(job.key);
+    if (it != _table.end())
+    {
+        return std::make_pair(it->second, false);
+    }
+    IndexType id = static_cast<IndexType>(_nodes.size());
+    _nodes.emplace_back();
+    SearchNode &node = _nodes.back();
+    node.key = job.key;
+    node.numGates = job.numGates;
+    node.depth = job.depth;
+    node.cost = cost(job.numGates, job.depth);
+    node.recipe = _nodes[job.parent].recipe;
+    node.recipe.emplace_back(job.action);
+    node.children.assign(_actions.size(), UNEXPANDED);
+    node.exhausted = node.recipe.size() >= _params.maxLength;
+    // A state at the length limit is never expanded, only keep the others
+    if (!node.exhausted)
+    {
+        node.state = std::move(job.state);
+        node.hasState = true;
+    }
+    _table[job.key] = id;
+    if (node.cost < _nodes[_best].cost
+            || (node.cost == _nodes[_best].cost && node.recipe.size() < _nodes[_best].recipe.size()))
+    {
+        _best = id;
+    }
+    updatePareto(node);
+    return std::make_pair(id, true);
+}
+
+/// Insert a design in the Pareto front if no other design dominates it
+template<class State>
+void RecipeSearch<State>::updatePareto(const SearchNode &node)
+{
+    for (const SearchPoint &p : _pareto)
+    {
+        if (p.numGates() <= node.numGates && p.depth() <= node.depth)
+        {
+            return;
+        }
+    }
+    _pareto.erase(std::remove_if(_pareto.begin(), _pareto.end(), [&](const SearchPoint &p) {
+        return node.numGates <= p.numGates() && node.depth <= p.depth();
+    }), _pareto.end());
+    SearchPoint point;
+    point.setNumGates(node.numGates);
+    point.setDepth(node.depth);
+    point.setCost(node.cost);
+    point.setRecipe(node.recipe);
+    auto pos = std::lower_bound(_pareto.begin(), _pareto.end(), point, [](const SearchPoint &a, const SearchPoint &b) {
+        return a.numGates() < b.numGates();
+    });
+    _pareto.insert(pos, point);
+}
+
+template<class State>
+void RecipeSearch<State>::runBeam()
+{
+    std::vector<IndexType> frontier(1, 0);
+    for (IndexType length = 0; length < _params.maxLength && !frontier.empty(); ++length)
+    {
+        MTL_TRACE_SPAN(DETAIL, "RecipeSearch::beamLevel");
+        std::vector<Expansion> jobs;
+        for (IndexType parent : frontier)
+        {
+            for (IndexType a = 0; a < _actions.size(); ++a)
+            {
+                if (_numExpansions + jobs.size() >= _params.maxExpansions)
+                {
+                    break;
+                }
+                jobs.emplace_back();
+                jobs.back().parent = parent;
+                jobs.back().action = a;
+            }
+        }
+        if (jobs.empty() || outOfTime())
+        {
+            break;
+        }
+        evaluate(jobs);
+
+        std::vector<IndexType> next;
+        for (Expansion &job : jobs)
+        {
+            if (!job.done)
+            {
+                continue;
+            }
+            auto merged = merge(job);
+            if (merged.second)
+            {
+                next.emplace_back(merged.first);
+            }
+        }
+        // Only the frontier is expanded again, drop the snapshots of the others
+        for (IndexType parent : frontier)
+        {
+            _nodes[parent].state = State();
+            _nodes[parent].hasState = false;
+        }
+        std::sort(next.begin(), next.end(), [&](IndexType a, IndexType b) { return _nodes[a].cost < _nodes[b].cost; });
+        for (IndexType i = _params.beamWidth; i < next.size(); ++i)
+        {
+            _nodes[next[i]].state = State();
+            _nodes[next[i]].hasState = false;
+        }
+        if (next.size() > _params.beamWidth)
+        {
+            next.resize(_params.beamWidth);
+        }
+        frontier.swap(next);
+    }
+}
+
+/// UCT over the children that still have an action to try below them.
+/// A child reached with a recipe no longer than the node's is a transposition
+/// to a state explored from its own position and is not descended into, so
+/// the descents follow a DAG.
+template<class State>
+IntType RecipeSearch<State>::selectChild(const SearchNode &node) const
+{
+    IntType bestChild = -1;
+    RealType bestScore = -std::numeric_limits<RealType>::infinity();
+    const RealType logVisits = std::log(static_cast<RealType>(std::max<IndexType>(node.visits + node.virtualLoss, 1)));
+    for (IntType child : node.children)
+    {
+        if (child < 0)
+        {
+            continue;
+        }
+        const SearchNode &c = _nodes[child];
+        if (c.exhausted || c.recipe.size() <= node.recipe.size())
+        {
+            continue;
+        }
+        const RealType n = static_cast<RealType>(c.visits + c.virtualLoss);
+        // A pending visit counts as a zero reward, which steers the rest of the batch elsewhere
+        const RealType q = n > 0 ? c.value / n : 0.0;
+        const RealType score = q + _params.exploration * std::sqrt(logVisits / std::max<RealType>(n, 1));
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestChild = child;
+        }
+    }
+    return bestChild;
+}
+
+/// Mark the nodes of a path exhausted from the bottom up: every action was
+/// tried and every child descended into is exhausted. Their snapshots are dropped
+template<class State>
+void RecipeSearch<State>::updateExhausted(const std::vector<IndexType> &path)
+{
+    for (auto it = path.rbegin(); it != path.rend(); ++it)
+    {
+        SearchNode &node = _nodes[*it];
+        if (!node.exhausted)
+        {
+            for (IntType child : node.children)
+            {
+                if (child < 0 || (_nodes[child].recipe.size() > node.recipe.size() && !_nodes[child].exhausted))
+                {
+                    return;
+                }
+            }
+            node.exhausted = true;
+        }
+        if (node.hasState)
+        {
+            node.state = State();
+            node.hasState = false;
+        }
+    }
+}
+
+template<class State>
+void RecipeSearch<State>::runMcts()
+{
+    const RealType rootCost = _nodes[0].cost;
+    auto reward = [&](const SearchNode &node) { return (rootCost - node.cost) / std::max<RealType>(rootCost, REAL_TYPE_TOL); };
+    const IndexType batchSize = numThreads();
+    auto backprop = [&](const std::vector<IndexType> &path, RealType r) {
+        for (IndexType id : path)
+        {
+            SearchNode &node = _nodes[id];
+            --node.virtualLoss;
+            ++node.visits;
+            node.value += r;
+        }
+    };
+
+    // A descent from a node that is not exhausted reaches an untried action,
+    // unless it is blocked by the pending slots of the same batch
+    while (!_nodes[0].exhausted && _numExpansions < _params.maxExpansions && !outOfTime())
+    {
+        MTL_TRACE_SPAN(DETAIL, "RecipeSearch::mctsBatch");
+        // Selection, one leaf per thread. Virtual losses spread the batch over the tree
+        std::vector<Expansion> jobs;
+        std::vector<std::vector<IndexType>> blocked;
+        for (IndexType b = 0; b < batchSize && _numExpansions + jobs.size() < _params.maxExpansions; ++b)
+        {
+            std::vector<IndexType> path(1, 0);
+            while (true)
+            {
+                SearchNode &node = _nodes[path.back()];
+                ++node.virtualLoss;
+                auto slot = std::find(node.children.begin(), node.children.end(), UNEXPANDED);
+                if (slot != node.children.end() && node.hasState)
+                {
+                    *slot = PENDING;
+                    jobs.emplace_back();
+                    jobs.back().parent = path.back();
+                    jobs.back().action = static_cast<IndexType>(slot - node.children.begin());
+                    jobs.back().path = path;
+                    break;
+                }
+                IntType child = selectChild(node);
+                if (child < 0)
+                {
+                    blocked.emplace_back(path);
+                    break;
+                }
+                path.emplace_back(static_cast<IndexType>(child));
+            }
+        }
+
+        evaluate(jobs);
+
+        // Backpropagation
+        for (Expansion &job : jobs)
+        {
+            if (!job.done)
+            {
+                _nodes[job.parent].children[job.action] = UNEXPANDED;
+                for (IndexType id : job.path) { --_nodes[id].virtualLoss; }
+                continue;
+            }
+            auto merged = merge(job);
+            _nodes[job.parent].children[job.action] = static_cast<IntType>(merged.first);
+            SearchNode &child = _nodes[merged.first];
+            ++child.visits;
+            child.value += reward(child);
+            backprop(job.path, reward(child));
+        }
+        for (const auto &path : blocked)
+        {
+            // Not a visit, only release the virtual losses. Its children may have been exhausted through other parents
+            for (IndexType id : path) { --_nodes[id].virtualLoss; }
+            updateExhausted(path);
+        }
+        for (const Expansion &job : jobs)
+        {
+            // Every action of the parent was tried: its snapshot is no longer needed
+            SearchNode &parent = _nodes[job.parent];
+            if (parent.hasState && std::find_if(parent.children.begin(), parent.children.end(),
+                        [](IntType child) { return child < 0; }) == parent.children.end())
+            {
+                parent.state = State();
+                parent.hasState = false;
+            }
+        }
+        for (const Expansion &job : jobs)
+        {
+            if (job.done)
+            {
+                std::vector<IndexType> path = job.path;
+                path.emplace_back(static_cast<IndexType>(_nodes[job.parent].children[job.action]));
+                updateExhausted(path);
+            }
+        }
+    }
+}
+
+PROJECT_NAMESPACE_END
+
+#endif // MTL_PY_RECIPE_SEARCH_H_
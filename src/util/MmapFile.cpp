@@ -0,0 +1,61 @@
+#include "MmapFile.h"
+#include "MsgPrinter.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+PROJECT_NAMESPACE_BEGIN
+
+/// Map the whole file read-only
+bool MmapFile::open(const std::string &filename)
+{
+    close();
+    _fd = ::open(filename.c_str(), O_RDONLY);
+    if (_fd < 0)
+    {
+        MsgPrinter::err("Cannot open file %s\n", filename.c_str());
+        return false;
+    }
+    struct stat st;
+    if (fstat(_fd, &st) != 0)
+    {
+        MsgPrinter::err("Cannot stat file %s\n", filename.c_str());
+        close();
+        return false;
+    }
+    _size = static_cast<std::size_t>(st.st_size);
+    if (_size == 0)
+    {
+        // mmap rejects empty mappings. An empty file is still a valid, empty input
+        return true;
+    }
+    void *addr = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        MsgPrinter::err("Cannot map file %s\n", filename.c_str());
+        close();
+        return false;
+    }
+    madvise(addr, _size, MADV_WILLNEED);
+    _data = static_cast<const char *>(addr);
+    return true;
+}
+
+/// Release the mapping and the descriptor
+void MmapFile::close()
+{
+    if (_data != nullptr)
+    {
+        munmap(const_cast<char *>(_data), _size);
+        _data = nullptr;
+    }
+    if (_fd >= 0)
+    {
+        ::close(_fd);
+        _fd = -1;
+    }
+    _size = 0;
+}
+
+PROJECT_NAMESPACE_END
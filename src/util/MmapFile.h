@@ -0,0 +1,55 @@
+#ifndef MTL_PY_MMAP_FILE_H_
+#define MTL_PY_MMAP_FILE_H_
+
+#include <cstddef>
+#include <streambuf>
+#include <string>
+#include "global/namespace.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// ================================================================================
+/// MmapFile, read-only memory mapping of a whole file
+/// The mapping is released when the object is destroyed.
+/// ================================================================================
+class MmapFile
+{
+    public:
+        explicit MmapFile() = default;
+        ~MmapFile() { close(); }
+        MmapFile(const MmapFile &) = delete;
+        MmapFile & operator=(const MmapFile &) = delete;
+
+        /// @brief map a file for sequential reading
+        /// @param filename
+        /// @return whether the file is mapped
+        bool open(const std::string &filename);
+        /// @brief unmap the file
+        void close();
+        /// @brief whether a file is mapped
+        bool isOpen() const { return _fd >= 0; }
+        /// @brief the mapped bytes
+        const char * data() const { return _data; }
+        /// @brief the size of the file in bytes
+        std::size_t size() const { return _size; }
+
+    private:
+        int          _fd = -1;          ///< File descriptor
+        const char * _data = nullptr;   ///< Start of the mapping
+        std::size_t  _size = 0;         ///< Size of the mapping
+};
+
+/// Read-only std::streambuf over mapped bytes, to feed stream based readers without copying
+class MmapStreamBuf : public std::streambuf
+{
+    public:
+        explicit MmapStreamBuf(const MmapFile &file)
+        {
+            char *begin = const_cast<char *>(file.data());
+            setg(begin, begin, begin + file.size());
+        }
+};
+
+PROJECT_NAMESPACE_END
+
+#endif // MTL_PY_MMAP_FILE_H_
@@ -1,5 +1,7 @@
 #include "MsgPrinter.h"
 #include "Assert.h"
+#include "Tracer.h"
+#include <vector>
 
 PROJECT_NAMESPACE_BEGIN
 
@@ -7,6 +9,7 @@ std::time_t MsgPrinter::_startTime = std::time(nullptr);
 FILE* MsgPrinter::_screenOutStream = stderr;
 FILE* MsgPrinter::_logOutStream = nullptr;
 std::string MsgPrinter::_logFileName = "";
+std::mutex MsgPrinter::_mutex;
 
 /// Converting enum type to std::string
 std::string msgTypeToStr(MsgType msgType) 
@@ -21,19 +24,58 @@ std::string msgTypeToStr(MsgType msgType)
     AssertMsg(false, "Unknown MsgType. \n");
 }
 
+/// Converting enum type to a static name for the tracer
+[[maybe_unused]] static const char * msgTypeName(MsgType msgType)
+{
+    switch (msgType)
+    {
+        case MsgType::INF:  return "INF";
+        case MsgType::WRN:  return "WRN";
+        case MsgType::ERR:  return "ERR";
+        case MsgType::DBG:  return "DBG";
+    }
+    return "MSG";
+}
+
+/// Turn on screen printing
+void MsgPrinter::screenOn()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _screenOutStream = stderr;
+}
+
+/// Turn off screen printing
+void MsgPrinter::screenOff()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _screenOutStream = nullptr;
+}
+
 /// Open a log file, all output will be stored in the log
+/// The streams are swapped under the lock, the messages are printed after releasing it
 void MsgPrinter::openLogFile(const std::string &logFileName) 
 {
-    if (_logOutStream != nullptr) 
+    std::string closedFileName;
+    bool closed = false;
+    bool opened = false;
     {
-        fclose(_logOutStream);
-        wrn("Current log file %s is forcibly closed\n", _logFileName.c_str());
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_logOutStream != nullptr) 
+        {
+            fclose(_logOutStream);
+            closedFileName = _logFileName;
+            closed = true;
+        }
+        _logFileName = logFileName;
+        _logOutStream = fopen(logFileName.c_str(), "w");
+        opened = _logOutStream != nullptr;
     }
 
-    _logFileName = logFileName;
-    _logOutStream = fopen(logFileName.c_str(), "w");
-
-    if (_logOutStream == nullptr) 
+    if (closed)
+    {
+        wrn("Current log file %s is forcibly closed\n", closedFileName.c_str());
+    }
+    if (!opened) 
     {
         err("Cannot open log file %s\n", logFileName.c_str());
     }
@@ -45,13 +87,25 @@ void MsgPrinter::openLogFile(const std::string &logFileName)
 /// Close current log file
 void MsgPrinter::closeLogFile() 
 {
-    if (_logOutStream == nullptr) 
+    bool opened;
+    std::string logFileName;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        opened = _logOutStream != nullptr;
+        logFileName = _logFileName;
+    }
+    if (!opened) 
     {
         wrn("No log file is opened. Call to %s is ignored.\n", __func__);
+        return;
     }
-    else 
+    // Printed before closing, so that the message also goes to the log
+    inf("Close log file %s.\n", logFileName.c_str());
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_logOutStream != nullptr)
     {
-        inf("Close log file %s.\n", _logFileName.c_str());
+        fclose(_logOutStream);
+        _logOutStream = nullptr;
     }
 }
 
@@ -98,36 +152,44 @@ void MsgPrinter::print(MsgType msgType, const char* rawFormat, va_list args)
     std::string type = "[" + msgTypeToStr(msgType);
 
     /// Get local time and elapsed time
-    struct tm* timeInfo;
+    struct tm timeInfo;
     std::time_t now = std::time(nullptr);
-    timeInfo = localtime(&now);
+    localtime_r(&now, &timeInfo);
     double elapsed = difftime(now, _startTime);
 
     /// Local time
     char locTime[32];
-    strftime(locTime, 32, " %F %T ", timeInfo);
+    strftime(locTime, 32, " %F %T ", &timeInfo);
 
     /// Elapsed time
     char elpTime[32];
     sprintf(elpTime, "%5.0lf sec]  ", elapsed);
 
+    // Format the message once, so that concurrent messages are written whole
+    va_list args_copy;
+    va_copy(args_copy, args);
+    int len = vsnprintf(nullptr, 0, rawFormat, args_copy);
+    va_end(args_copy);
+    std::vector<char> body(len > 0 ? len + 1 : 1, '\0');
+    vsnprintf(body.data(), body.size(), rawFormat, args);
+
+    MTL_TRACE_INSTANT(DETAIL, msgTypeName(msgType), std::string(body.data()));
+
     // Combine all the strings together
-    std::string format = type + std::string(locTime) + std::string(elpTime) + std::string(rawFormat);
+    std::string msg = type + std::string(locTime) + std::string(elpTime) + std::string(body.data());
 
+    std::lock_guard<std::mutex> lock(_mutex);
     // print to log
     if (_logOutStream)
     {
-        va_list args_copy;
-        va_copy(args_copy, args);
-        vfprintf(_logOutStream, format.c_str(), args_copy);
-        va_end(args_copy);
+        fputs(msg.c_str(), _logOutStream);
         fflush(_logOutStream);
     }
 
     // print to screen
     if (_screenOutStream)
     {
-        vfprintf(_screenOutStream, format.c_str(), args);
+        fputs(msg.c_str(), _screenOutStream);
         fflush(_screenOutStream);
     }
 }
@@ -5,6 +5,7 @@
 #include <string>
 #include <ctime>
 #include <cstdarg>
+#include <mutex>
 #include "global/namespace.h"
 
 PROJECT_NAMESPACE_BEGIN
@@ -28,12 +29,14 @@ enum class MsgType
 std::string msgTypeToStr(MsgType msgType);
 
 /// Message printing class
+/// Thread-safe: a message is formatted first and written under a lock, so
+/// messages from different threads never interleave.
 class MsgPrinter 
 {
     public:
         static void startTimer() { _startTime = std::time(nullptr); } // Cache start time
-        static void screenOn()   { _screenOutStream = stderr; }       // Turn on screen printing
-        static void screenOff()  { _screenOutStream = nullptr; }      // Turn off screen printing
+        static void screenOn();                                        // Turn on screen printing
+        static void screenOff();                                       // Turn off screen printing
 
         static void openLogFile(const std::string &file);
         static void closeLogFile();
@@ -50,6 +53,7 @@ class MsgPrinter
         static FILE *        _screenOutStream;  // Out stream for screen printing
         static FILE *        _logOutStream;     // Out stream for log printing
         static std::string   _logFileName;      // Current log file name
+        static std::mutex    _mutex;            // Guards the streams and the writes to them
 };
 
 PROJECT_NAMESPACE_END
@@ -0,0 +1,88 @@
+#include "SharedMemory.h"
+#include "MsgPrinter.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+PROJECT_NAMESPACE_BEGIN
+
+/// Create a new segment with the given size and map it read-write
+bool SharedMemory::create(const std::string &name, std::size_t size)
+{
+    close();
+    const std::string shm = shmName(name);
+    // Replace the segment object instead of truncating it: processes that map
+    // the previous one keep reading it whole until they unmap it
+    shm_unlink(shm.c_str());
+    int fd = shm_open(shm.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        MsgPrinter::err("Cannot create shared memory %s\n", shm.c_str());
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        MsgPrinter::err("Cannot resize shared memory %s to %lu bytes\n", shm.c_str(), size);
+        ::close(fd);
+        return false;
+    }
+    void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping keeps the segment
+    if (addr == MAP_FAILED)
+    {
+        MsgPrinter::err("Cannot map shared memory %s\n", shm.c_str());
+        return false;
+    }
+    _data = static_cast<char *>(addr);
+    _size = size;
+    return true;
+}
+
+/// Map the whole existing segment read-only
+bool SharedMemory::attach(const std::string &name)
+{
+    close();
+    const std::string shm = shmName(name);
+    int fd = shm_open(shm.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+        MsgPrinter::err("Cannot open shared memory %s\n", shm.c_str());
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        MsgPrinter::err("Shared memory %s is empty\n", shm.c_str());
+        ::close(fd);
+        return false;
+    }
+    void *addr = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+    {
+        MsgPrinter::err("Cannot map shared memory %s\n", shm.c_str());
+        return false;
+    }
+    _data = static_cast<char *>(addr);
+    _size = static_cast<std::size_t>(st.st_size);
+    return true;
+}
+
+/// Release the mapping
+void SharedMemory::close()
+{
+    if (_data != nullptr)
+    {
+        munmap(_data, _size);
+        _data = nullptr;
+    }
+    _size = 0;
+}
+
+bool SharedMemory::unlink(const std::string &name)
+{
+    return shm_unlink(shmName(name).c_str()) == 0;
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,53 @@
+#ifndef MTL_PY_SHARED_MEMORY_H_
+#define MTL_PY_SHARED_MEMORY_H_
+
+#include <cstddef>
+#include <string>
+#include "global/namespace.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// ================================================================================
+/// SharedMemory, a POSIX shared-memory segment mapped into this process
+/// The segment outlives the processes that map it until it is unlinked.
+/// ================================================================================
+class SharedMemory
+{
+    public:
+        explicit SharedMemory() = default;
+        ~SharedMemory() { close(); }
+        SharedMemory(const SharedMemory &) = delete;
+        SharedMemory & operator=(const SharedMemory &) = delete;
+
+        /// @brief create a segment and map it read-write
+        /// A segment of the same name is unlinked first, its existing mappings stay valid
+        /// @param the segment name. A leading '/' is added if missing
+        /// @param the size in bytes
+        /// @return whether the segment is mapped
+        bool create(const std::string &name, std::size_t size);
+        /// @brief map an existing segment read-only
+        /// @param the segment name
+        /// @return whether the segment is mapped
+        bool attach(const std::string &name);
+        /// @brief unmap the segment. The segment itself is kept
+        void close();
+        /// @brief remove a segment. Existing mappings stay valid
+        /// @return whether the segment existed
+        static bool unlink(const std::string &name);
+
+        bool isOpen() const { return _data != nullptr; }
+        char * data() { return _data; }
+        const char * data() const { return _data; }
+        std::size_t size() const { return _size; }
+
+    private:
+        static std::string shmName(const std::string &name) { return name.empty() || name[0] != '/' ? "/" + name : name; }
+
+    private:
+        char *       _data = nullptr;   ///< Start of the mapping
+        std::size_t  _size = 0;         ///< Size of the mapping
+};
+
+PROJECT_NAMESPACE_END
+
+#endif // MTL_PY_SHARED_MEMORY_H_
@@ -0,0 +1,147 @@
+#include "Tracer.h"
+#include <cstdio>
+#include <unistd.h>
+
+PROJECT_NAMESPACE_BEGIN
+
+std::atomic<std::int32_t> Tracer::_level(static_cast<std::int32_t>(TraceLevel::OFF));
+std::size_t Tracer::_capacity = 1 << 16;
+const std::chrono::steady_clock::time_point Tracer::_epoch = std::chrono::steady_clock::now();
+std::mutex Tracer::_registryMutex;
+std::vector<TraceBuffer *> Tracer::_registry;
+
+namespace
+{
+    /// Escape a string for a JSON string literal
+    void writeJsonString(FILE *out, const char *str)
+    {
+        fputc('"', out);
+        for (const char *c = str; *c != '\0'; ++c)
+        {
+            switch (*c)
+            {
+                case '"':  fputs("\\\"", out); break;
+                case '\\': fputs("\\\\", out); break;
+                case '\n': fputs("\\n", out); break;
+                case '\t': fputs("\\t", out); break;
+                case '\r': fputs("\\r", out); break;
+                default:
+                    if (static_cast<unsigned char>(*c) < 0x20) { fprintf(out, "\\u%04x", *c); }
+                    else { fputc(*c, out); }
+            }
+        }
+        fputc('"', out);
+    }
+}
+
+std::vector<TraceEvent> TraceBuffer::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<TraceEvent> events;
+    events.reserve(_size);
+    std::size_t first = (_head + _events.size() - _size) % _events.size();
+    for (std::size_t i = 0; i < _size; ++i)
+    {
+        events.emplace_back(_events[(first + i) % _events.size()]);
+    }
+    return events;
+}
+
+void TraceBuffer::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _head = 0;
+    _size = 0;
+}
+
+void Tracer::setBufferCapacity(std::size_t capacity)
+{
+    // Read by threadBuffer under the same lock
+    std::lock_guard<std::mutex> lock(_registryMutex);
+    _capacity = capacity > 0 ? capacity : 1;
+}
+
+/// Get the buffer of the calling thread, registering it on first use
+TraceBuffer & Tracer::threadBuffer()
+{
+    thread_local TraceBuffer *buffer = nullptr;
+    if (buffer == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(_registryMutex);
+        // Buffers outlive their threads so that the events of joined workers can still be exported
+        buffer = new TraceBuffer(static_cast<std::uint32_t>(_registry.size()), _capacity);
+        _registry.emplace_back(buffer);
+    }
+    return *buffer;
+}
+
+void Tracer::span(const char *name, std::int64_t beginNs, std::int64_t durNs)
+{
+    TraceEvent event;
+    event.name = name;
+    event.beginNs = beginNs;
+    event.durNs = durNs;
+    threadBuffer().push(std::move(event));
+}
+
+void Tracer::instant(const char *name, std::string msg)
+{
+    TraceEvent event;
+    event.name = name;
+    event.beginNs = now();
+    event.msg = std::move(msg);
+    threadBuffer().push(std::move(event));
+}
+
+bool Tracer::dumpChromeTrace(const std::string &filename)
+{
+    FILE *out = fopen(filename.c_str(), "w");
+    if (out == nullptr)
+    {
+        return false;
+    }
+    std::vector<TraceBuffer *> buffers;
+    {
+        std::lock_guard<std::mutex> lock(_registryMutex);
+        buffers = _registry;
+    }
+    const int pid = static_cast<int>(getpid());
+    bool first = true;
+    fputs("{\"traceEvents\":[\n", out);
+    for (const TraceBuffer *buffer : buffers)
+    {
+        for (const TraceEvent &event : buffer->snapshot())
+        {
+            if (!first) { fputs(",\n", out); }
+            first = false;
+            fputs("{\"name\":", out);
+            writeJsonString(out, event.name);
+            // Chrome expects microseconds
+            fprintf(out, ",\"cat\":\"mtlPy\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f", pid, buffer->tid(), event.beginNs / 1000.0);
+            if (event.durNs >= 0)
+            {
+                fprintf(out, ",\"ph\":\"X\",\"dur\":%.3f}", event.durNs / 1000.0);
+            }
+            else
+            {
+                fputs(",\"ph\":\"i\",\"s\":\"t\",\"args\":{\"msg\":", out);
+                writeJsonString(out, event.msg.c_str());
+                fputs("}}", out);
+            }
+        }
+    }
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", out);
+    fclose(out);
+    return true;
+}
+
+void Tracer::clear()
+{
+    std::lock_guard<std::mutex> lock(_registryMutex);
+    for (TraceBuffer *buffer : _registry)
+    {
+        buffer->clear();
+    }
+}
+
+PROJECT_NAMESPACE_END
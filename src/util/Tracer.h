@@ -0,0 +1,150 @@
+#ifndef MTL_PY_TRACER_H_
+#define MTL_PY_TRACER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "global/namespace.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// ================================================================================
+/// Tracer, low-overhead structured tracing of the interface operations
+/// Every thread records into its own fixed-size ring buffer, so recording a span
+/// never contends with other threads. The buffers are exported as Chrome
+/// trace-event JSON (chrome://tracing, Perfetto).
+///
+/// Levels are selected at runtime with Tracer::setLevel(). Building without
+/// MTL_PY_ENABLE_TRACE turns the MTL_TRACE_* macros into no-ops.
+/// ================================================================================
+
+/// Enum type for trace verbosity
+enum class TraceLevel : std::int32_t
+{
+    OFF = 0,    ///< Record nothing
+    OP = 1,     ///< One span per interface operation
+    DETAIL = 2, ///< Also the phases inside an operation and the messages
+    ALL = 3     ///< Everything, including per-item work inside parallel loops
+};
+
+/// A single recorded event
+struct TraceEvent
+{
+    const char *   name = nullptr;  ///< Static string, never owned
+    std::int64_t   beginNs = 0;     ///< Begin time since the tracer epoch
+    std::int64_t   durNs = -1;      ///< Duration. -1 for instant events
+    std::string    msg;             ///< Optional payload (messages only)
+};
+
+/// Per-thread ring buffer of events
+class TraceBuffer
+{
+    public:
+        explicit TraceBuffer(std::uint32_t tid, std::size_t capacity) : _tid(tid), _events(capacity) {}
+        /// @brief append an event, overwriting the oldest one when full
+        void push(TraceEvent &&event)
+        {
+            std::lock_guard<std::mutex> lock(_mutex); // Only contended while exporting
+            _events[_head] = std::move(event);
+            _head = (_head + 1) % _events.size();
+            if (_size < _events.size()) { ++_size; }
+        }
+        /// @brief copy out the events, oldest first
+        std::vector<TraceEvent> snapshot() const;
+        /// @brief drop all the recorded events
+        void clear();
+        std::uint32_t tid() const { return _tid; }
+
+    private:
+        std::uint32_t           _tid = 0;     ///< Trace thread id
+        std::vector<TraceEvent> _events;      ///< The ring storage
+        std::size_t             _head = 0;    ///< Next slot to write
+        std::size_t             _size = 0;    ///< Number of valid events
+        mutable std::mutex      _mutex;       ///< Guards against concurrent export
+};
+
+/// Tracing front end
+class Tracer
+{
+    public:
+        /// @brief set the runtime trace level
+        static void setLevel(TraceLevel level) { _level.store(static_cast<std::int32_t>(level), std::memory_order_relaxed); }
+        /// @brief get the runtime trace level
+        static TraceLevel level() { return static_cast<TraceLevel>(_level.load(std::memory_order_relaxed)); }
+        /// @brief whether events at this level are recorded
+        static bool enabled(TraceLevel level) { return static_cast<std::int32_t>(level) <= _level.load(std::memory_order_relaxed); }
+        /// @brief set the number of events kept per thread. Applies to threads that have not traced yet
+        static void setBufferCapacity(std::size_t capacity);
+        /// @brief nanoseconds since the tracer epoch
+        static std::int64_t now()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _epoch).count();
+        }
+
+        /// @brief record a complete span
+        static void span(const char *name, std::int64_t beginNs, std::int64_t durNs);
+        /// @brief record an instant event carrying a message
+        static void instant(const char *name, std::string msg);
+
+        /// @brief write all the buffers as Chrome trace-event JSON
+        /// @return whether the file is written
+        static bool dumpChromeTrace(const std::string &filename);
+        /// @brief drop the events of all threads
+        static void clear();
+
+    private:
+        static TraceBuffer & threadBuffer();
+
+    private:
+        static std::atomic<std::int32_t>                   _level;     ///< Runtime level
+        static std::size_t                                  _capacity;  ///< Events per thread
+        static const std::chrono::steady_clock::time_point  _epoch;     ///< Time origin
+        static std::mutex                                   _registryMutex;
+        static std::vector<TraceBuffer *>                   _registry;  ///< All the thread buffers. Never freed
+};
+
+/// RAII span, records [construction, destruction) when its level is enabled
+class TraceSpan
+{
+    public:
+        explicit TraceSpan(TraceLevel level, const char *name)
+            : _name(Tracer::enabled(level) ? name : nullptr), _beginNs(_name ? Tracer::now() : 0) {}
+        ~TraceSpan() { if (_name) { Tracer::span(_name, _beginNs, Tracer::now() - _beginNs); } }
+        TraceSpan(const TraceSpan &) = delete;
+        TraceSpan & operator=(const TraceSpan &) = delete;
+
+    private:
+        const char *  _name;
+        std::int64_t  _beginNs;
+};
+
+PROJECT_NAMESPACE_END
+
+#define MTL_TRACE_CONCAT_IMPL(a, b) a##b
+#define MTL_TRACE_CONCAT(a, b) MTL_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef MTL_PY_ENABLE_TRACE
+// Trace the enclosing scope
+#define MTL_TRACE_SPAN(level, name) \
+        PROJECT_NAMESPACE::TraceSpan MTL_TRACE_CONCAT(_mtlTraceSpan, __LINE__)(PROJECT_NAMESPACE::TraceLevel::level, name)
+// Trace an instant event
+#define MTL_TRACE_INSTANT(level, name, msg) \
+        do { \
+            if (PROJECT_NAMESPACE::Tracer::enabled(PROJECT_NAMESPACE::TraceLevel::level)) \
+            { \
+                PROJECT_NAMESPACE::Tracer::instant(name, msg); \
+            } \
+        } while (false)
+#else // MTL_PY_ENABLE_TRACE
+#define MTL_TRACE_SPAN(level, name) \
+        do { \
+        } while (false)
+#define MTL_TRACE_INSTANT(level, name, msg) \
+        do { \
+        } while (false)
+#endif // MTL_PY_ENABLE_TRACE
+
+#endif // MTL_PY_TRACER_H_